@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// interns class names into dense ids [0, size()), lookups hash the
+// string_view directly so a hit never allocates
+class ClassDictionary {
+   public:
+    static constexpr std::uint32_t NoId = 0xffffffff;
+
+    std::uint32_t intern(std::string_view name);
+    std::uint32_t find(std::string_view name) const;
+    std::string_view name(std::uint32_t id) const { return m_names[id]; }
+    std::uint32_t size() const {
+        return static_cast<std::uint32_t>(m_names.size());
+    }
+    void clear();
+
+   private:
+    static std::uint64_t hash(std::string_view name);
+    std::size_t slotOf(std::string_view name, std::uint64_t nameHash) const;
+    void rehash(std::size_t slotCount);
+
+    std::vector<std::string> m_names;
+    std::vector<std::uint64_t> m_hashes;  // hash of every name, by id
+    std::vector<std::uint32_t> m_slots;   // open addressing, id + 1 or 0
+};
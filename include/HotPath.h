@@ -0,0 +1,93 @@
+#pragma once
+// hot path instrumentation, only compiled in when LOGREADER_HOT_PATH_STATS is
+// defined (cmake -DLOGREADER_HOT_PATH_STATS=ON), otherwise every macro
+// expands to nothing. Use these inside per-line loops instead of Logger
+//
+// HOT_PATH_COUNT(name)         count events
+// HOT_PATH_ADD(name, value)    add value to a counter
+// HOT_PATH_SAMPLE(name, value) count calls, aggregate every 64th value
+// HOT_PATH_SCOPE(name)         aggregate the time spent in the scope
+// HOT_PATH_REPORT()            write all aggregates to the debug log
+
+#if defined(LOGREADER_HOT_PATH_STATS)
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace HotPath {
+struct Counter {
+    Counter(const char* name);
+    const char* name;
+    std::atomic<std::uint64_t> value;
+    Counter* next;
+};
+
+struct Sample {
+    static constexpr std::uint64_t Every = 64;
+
+    Sample(const char* name);
+    void record(std::uint64_t value);
+    const char* name;
+    std::atomic<std::uint64_t> calls;
+    std::atomic<std::uint64_t> samples;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> max;
+    Sample* next;
+};
+
+struct Timer {
+    Timer(const char* name);
+    void record(std::uint64_t nanoseconds);
+    const char* name;
+    std::atomic<std::uint64_t> calls;
+    std::atomic<std::uint64_t> totalNanoseconds;
+    std::atomic<std::uint64_t> maxNanoseconds;
+    Timer* next;
+};
+
+class ScopedTimer {
+   public:
+    ScopedTimer(Timer& timer)
+        : m_timer(timer), m_start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_timer.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()));
+    }
+
+   private:
+    Timer& m_timer;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+void report();
+}  // namespace HotPath
+
+#define HOT_PATH_CONCAT_(a, b) a##b
+#define HOT_PATH_CONCAT(a, b) HOT_PATH_CONCAT_(a, b)
+#define HOT_PATH_ADD(name, amount)                                \
+    do {                                                          \
+        static HotPath::Counter hotPathCounter(name);             \
+        hotPathCounter.value.fetch_add(                           \
+            static_cast<std::uint64_t>(amount),                   \
+            std::memory_order_relaxed);                           \
+    } while (0)
+#define HOT_PATH_COUNT(name) HOT_PATH_ADD(name, 1)
+#define HOT_PATH_SAMPLE(name, amount)                             \
+    do {                                                          \
+        static HotPath::Sample hotPathSample(name);               \
+        hotPathSample.record(static_cast<std::uint64_t>(amount)); \
+    } while (0)
+#define HOT_PATH_SCOPE(name)                                             \
+    static HotPath::Timer HOT_PATH_CONCAT(hotPathTimer, __LINE__)(name); \
+    HotPath::ScopedTimer HOT_PATH_CONCAT(hotPathScope, __LINE__)(        \
+        HOT_PATH_CONCAT(hotPathTimer, __LINE__))
+#define HOT_PATH_REPORT() HotPath::report()
+#else
+#define HOT_PATH_ADD(name, amount) ((void)0)
+#define HOT_PATH_COUNT(name) ((void)0)
+#define HOT_PATH_SAMPLE(name, amount) ((void)0)
+#define HOT_PATH_SCOPE(name) ((void)0)
+#define HOT_PATH_REPORT() ((void)0)
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#include <LineIndex.h>
+#include <LogFile.h>
+#include <LogTable.h>
+#include <TemplateMiner.h>
+#include <TrigramIndex.h>
+
+#include <QString>
+#include <cstdint>
+
+// sidecar of a log file, app.log.lridx next to app.log, holding the line
+// index, parsed columns, class names, level counts, trigram index and
+// templates of the log up to indexedSize bytes. Opening the log again loads
+// them instead of parsing, the columns are used in place from the mapped
+// sidecar. A sidecar only counts for the log it was written from, which has
+// the same size and modification time or has grown since, and the same
+// bytes at its head and before the end of the indexed part
+class IndexFile {
+   public:
+    // bumped whenever the layout of a saved part changes
+    static constexpr std::uint32_t Version = 1;
+
+    IndexFile(const QString& logFileName);
+
+    QString fileName() const { return m_fileName; }
+
+    // restores what the sidecar holds for logFile and returns the indexed
+    // bytes of the log, 0 leaves everything empty when there is no valid
+    // sidecar. Without trigramIndex the saved one is skipped
+    std::uint64_t load(const LogFile& logFile, LineIndex& lineIndex,
+                       LogTable& table, LevelCounts& levelCounts,
+                       TrigramIndex* trigramIndex, TemplateMiner& miner);
+    // replaces the sidecar atomically, an empty trigram index is saved
+    // without trigramIndex
+    bool save(const LogFile& logFile, const LineIndex& lineIndex,
+              const LogTable& table, const LevelCounts& levelCounts,
+              const TrigramIndex* trigramIndex,
+              const TemplateMiner& miner) const;
+
+   private:
+    // bytes hashed at the head of the log and before the indexed end
+    static constexpr std::uint64_t HashBytes = 4096;
+
+    static std::uint64_t hash(const LogText& text);
+    static qint64 modificationTime(const LogFile& logFile);
+
+    QString m_fileName;
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include <SnapshotVector.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// sequential writer of an index file. Values and arrays start at a
+// multiple of 8 bytes, so an array of a mapped file can be used in place.
+// Arrays are prefixed with their element count, the bytes go to a sink
+// that returns false when it fails, which makes every later write a no-op
+class IndexWriter {
+   public:
+    using Sink = std::function<bool(const char* data, std::size_t size)>;
+
+    explicit IndexWriter(Sink sink) : m_sink(std::move(sink)), m_size(0) {}
+
+    bool ok() const { return m_sink != nullptr; }
+    std::uint64_t size() const { return m_size; }
+
+    template <typename T>
+    void write(T value) {
+        static_assert(std::is_trivially_copyable<T>::value);
+        writeBytes(&value, sizeof(T));
+    }
+    template <typename T>
+    void writeArray(const T* data, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value);
+        write<std::uint64_t>(count);
+        writeBytes(data, count * sizeof(T));
+    }
+    void writeString(std::string_view text) {
+        writeArray(text.data(), text.size());
+    }
+
+   private:
+    static constexpr std::size_t Alignment = 8;
+
+    void writeBytes(const void* data, std::size_t size) {
+        static const char padding[Alignment] = {};
+        const auto padded = (Alignment - size % Alignment) % Alignment;
+        if (m_sink == nullptr ||
+            (size != 0 && !m_sink(static_cast<const char*>(data), size)) ||
+            (padded != 0 && !m_sink(padding, padded))) {
+            m_sink = nullptr;
+            return;
+        }
+        m_size += size + padded;
+    }
+
+    Sink m_sink;
+    std::uint64_t m_size;
+};
+
+// reads what an IndexWriter wrote from memory that owner keeps alive.
+// Reading past the end or an array longer than the rest of the data fails
+// the reader, which then only returns empty values
+class IndexReader {
+   public:
+    IndexReader(const char* data, std::size_t size,
+                std::shared_ptr<const void> owner)
+        : m_data(data),
+          m_size(size),
+          m_position(0),
+          m_owner(std::move(owner)) {}
+
+    bool ok() const { return m_data != nullptr; }
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value);
+        T value{};
+        if (auto bytes = readBytes(1, sizeof(T))) {
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+    }
+    // elements used in place, the view keeps the owner alive
+    template <typename T>
+    SnapshotVector<T> readView() {
+        auto count = read<std::uint64_t>();
+        auto bytes = readBytes(count, sizeof(T));
+        if (bytes == nullptr) {
+            return {};
+        }
+        return SnapshotVector<T>::view(reinterpret_cast<const T*>(bytes),
+                                       count, m_owner);
+    }
+    template <typename T>
+    std::vector<T> readVector() {
+        auto count = read<std::uint64_t>();
+        auto bytes = readBytes(count, sizeof(T));
+        if (bytes == nullptr || count == 0) {
+            return {};
+        }
+        std::vector<T> values(count);
+        std::memcpy(values.data(), bytes, count * sizeof(T));
+        return values;
+    }
+    // points into the data
+    std::string_view readString() {
+        auto count = read<std::uint64_t>();
+        auto bytes = readBytes(count, 1);
+        return bytes == nullptr ? std::string_view()
+                                : std::string_view(bytes, count);
+    }
+    // marks the data as invalid, e.g. when sizes disagree
+    void fail() { m_data = nullptr; }
+
+   private:
+    static constexpr std::size_t Alignment = 8;
+
+    const char* readBytes(std::uint64_t count, std::size_t elementSize) {
+        if (m_data == nullptr) {
+            return nullptr;
+        }
+        const auto available = m_size - m_position;
+        if (count > available / elementSize) {
+            fail();
+            return nullptr;
+        }
+        auto bytes = m_data + m_position;
+        const auto size = count * elementSize;
+        m_position += std::min<std::uint64_t>(
+            available, size + (Alignment - size % Alignment) % Alignment);
+        return bytes;
+    }
+
+    const char* m_data;
+    std::size_t m_size;
+    std::size_t m_position;
+    std::shared_ptr<const void> m_owner;
+};
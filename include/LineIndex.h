@@ -0,0 +1,60 @@
+#pragma once
+#include <IndexStream.h>
+#include <LogText.h>
+#include <SnapshotVector.h>
+
+#include <cstdint>
+
+// start offset of every line of a log, built with a vectorized newline scan
+// so lines can be addressed by index afterwards. The log can be indexed at
+// once or chunk by chunk while it is read, copies are snapshots that share
+// the offsets
+class LineIndex {
+   public:
+    LineIndex();
+
+    void build(const char* data, std::uint64_t size);
+    // indexes the lines ending in [indexedSize(), text.end()), the last
+    // line without line ending is only indexed when atEnd is set. text
+    // starts at or before indexedSize()
+    void append(const LogText& text, bool atEnd);
+    // empty index whose first line starts at begin, to index a chunk
+    void reset(std::uint64_t begin);
+    // appends the lines of an index that starts at indexedSize()
+    void extend(const LineIndex& next);
+    // keeps the first lineCount lines, to parse the following ones again
+    void truncate(std::uint64_t lineCount);
+    void clear();
+    // load uses the saved offsets in place and fails the reader unless they
+    // ascend from 0
+    void save(IndexWriter& writer) const;
+    void load(IndexReader& reader);
+
+    bool endsWithPartialLine() const { return m_endsWithPartialLine; }
+    std::uint64_t indexedSize() const {
+        return m_offsets.empty() ? 0 : m_offsets.back();
+    }
+
+    std::uint64_t lineCount() const {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+    // [lineBegin, lineEnd) includes the line ending
+    std::uint64_t lineBegin(std::uint64_t index) const {
+        return m_offsets[index];
+    }
+    std::uint64_t lineEnd(std::uint64_t index) const {
+        return m_offsets[index + 1];
+    }
+    // number of lines ending at or before offset
+    std::uint64_t linesBefore(std::uint64_t offset) const;
+
+   private:
+    // appends the offset following every '\n' in [begin, end)
+    static void scanNewlines(const LogText& text, std::uint64_t begin,
+                             std::uint64_t end,
+                             SnapshotVector<std::uint64_t>& offsets);
+
+    // line starts followed by the end offset of the last line
+    SnapshotVector<std::uint64_t> m_offsets;
+    bool m_endsWithPartialLine;  // last line has no line ending
+};
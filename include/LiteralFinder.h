@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// finds a literal in raw bytes with a first/last byte filter: 32 (AVX2) or
+// 16 (SSE2) positions are compared against the first and the last byte of
+// the literal at once and only positions where both match are compared in
+// full. Without matchCase ASCII letters match in either case
+class LiteralFinder {
+   public:
+    LiteralFinder(std::string literal = std::string(), bool matchCase = true);
+
+    const std::string& literal() const { return m_literal; }
+    bool matchCase() const { return m_matchCase; }
+
+    // offset of the first match in [begin, end) or end
+    std::uint64_t find(const char* data, std::uint64_t begin,
+                       std::uint64_t end) const;
+
+   private:
+    bool matchesAt(const char* text) const;
+
+    std::string m_literal;  // in lower case unless m_matchCase
+    bool m_matchCase;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <LogFile.h>
+#include <LogText.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// text of a gzip or zstd compressed log, nothing is inflated to disk and
+// the whole text is never in memory. Loading streams the text chunk by
+// chunk ahead of the parser and keeps only the chunk being parsed. On the
+// way it records restart points: for gzip every RestartSpan bytes at a
+// deflate block boundary with the 32 KiB window before it (as zran.c of
+// zlib does), for zstd at frame boundaries. The seek table at the end of a
+// seekable zstd file gives those before loading. text() decompresses a
+// range again from the restart point before it into pages, the last
+// CachedPages of which are kept. Pages far behind any restart point, in a
+// single zstd frame, are kept compressed again instead. Concatenated gzip
+// members and zstd frames, as written by log rotation and the seekable zstd
+// format, are read one after the other
+class LogDecompressor {
+   public:
+    enum class Format { None, Gzip, Zstd };
+
+    // format told by the magic bytes at the start of file
+    static Format formatOf(const LogFile& file);
+    // the library of format was found when building
+    static bool isBuiltIn(Format format);
+
+    LogDecompressor(std::shared_ptr<const LogFile> compressed);
+    ~LogDecompressor();
+
+    LogDecompressor(const LogDecompressor&) = delete;
+    LogDecompressor& operator=(const LogDecompressor&) = delete;
+
+    // decompresses bytes more text unless the end comes first, the text
+    // before keepFrom is dropped from memory. Damaged or truncated data and
+    // formats whose library was not built in return false and end the text
+    // there
+    bool decompress(std::uint64_t keepFrom, std::uint64_t bytes);
+    bool atEnd() const { return m_atEnd; }
+    // compressed bytes read so far
+    std::uint64_t consumedBytes() const { return m_consumed; }
+    // bytes of text decompressed so far
+    std::uint64_t size() const { return m_size; }
+    // bytes [begin, end) of the text clipped to size(), any thread may read
+    LogText text(std::uint64_t begin, std::uint64_t end) const;
+
+   private:
+    static constexpr std::uint64_t PageBytes = 1024 * 1024;
+    static constexpr std::size_t CachedPages = 16;
+    // text between gzip restart points
+    static constexpr std::uint64_t RestartSpan = 2 * 1024 * 1024;
+    // pages further behind a restart point are kept compressed
+    static constexpr std::uint64_t MaxRestartBytes = 8 * 1024 * 1024;
+
+    // where decoding can start again. For gzip inside a member, the bits
+    // of the byte before input that are still to be read and the text
+    // before output that deflate may refer back to
+    struct Checkpoint {
+        std::uint64_t output;
+        std::uint64_t input;
+        int bits;
+        std::vector<unsigned char> window;
+    };
+    class Decoder;  // state of the zlib or zstd decoder
+
+    void readSeekTable();
+    const Checkpoint& checkpointBefore(std::uint64_t offset) const;
+    // keeps the pages decompress() finished in [begin, end) that lie too
+    // far behind their restart point
+    void storePages(std::uint64_t begin, std::uint64_t end);
+    LogText page(std::uint64_t index) const;
+    void decodePage(std::uint64_t begin, char* data, std::uint64_t size) const;
+
+    std::shared_ptr<const LogFile> m_compressed;
+    Format m_format;
+    std::unique_ptr<Decoder> m_stream;  // of loading
+    std::uint64_t m_consumed;
+    bool m_atEnd;
+    std::atomic<std::uint64_t> m_size;
+
+    // what text() reads, behind m_mutex. Checkpoints ascend by output
+    mutable std::mutex m_mutex;
+    LogText m_window;  // text of the last chunk
+    std::vector<Checkpoint> m_checkpoints;
+    std::vector<std::string> m_storedPages;  // compressed, by page index
+    mutable std::vector<LogText> m_pages;    // least recently used first
+    mutable std::unique_ptr<Decoder> m_reader;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <LineIndex.h>
+#include <LogFile.h>
+#include <LogTable.h>
+#include <LogText.h>
+#include <TimeIndex.h>
+
+#include <cstdint>
+#include <memory>
+
+// immutable snapshot of an opened log, the file with the line index and
+// parsed columns of its first lineCount() lines. It is shared between the
+// ui and the processor thread by pointer, lines are read from the file as
+// they are shown. Snapshots of the same generation extend each other, but
+// for a last line without line ending that following takes back. A
+// followed file that was truncated or replaced starts a new generation
+class LogDocument {
+   public:
+    LogDocument(std::shared_ptr<const LogFile> source,
+                std::shared_ptr<const LogFile> logFile,
+                std::uint64_t generation, LineIndex lineIndex,
+                LogTable logTable, TimeIndex timeIndex, bool complete);
+
+    // file opened by the ui, logFile() opens it again whenever it grows
+    const std::shared_ptr<const LogFile>& source() const { return m_source; }
+    const std::shared_ptr<const LogFile>& logFile() const { return m_logFile; }
+    std::uint64_t generation() const { return m_generation; }
+    const LogFile& file() const { return *m_logFile; }
+    const LineIndex& lineIndex() const { return m_lineIndex; }
+    const LogTable& table() const { return m_logTable; }
+    const TimeIndex& timeIndex() const { return m_timeIndex; }
+    // false while later parts of the file are still being loaded
+    bool isComplete() const { return m_complete; }
+
+    std::size_t lineCount() const { return m_lineIndex.lineCount(); }
+    // text of a line without its line ending
+    LogText line(std::size_t index) const;
+
+   private:
+    std::shared_ptr<const LogFile> m_source;
+    std::shared_ptr<const LogFile> m_logFile;
+    std::uint64_t m_generation;
+    LineIndex m_lineIndex;
+    LogTable m_logTable;  // one row per line
+    TimeIndex m_timeIndex;
+    bool m_complete;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <LogText.h>
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+class LogDecompressor;
+
+// read-only log file. A mapped file is paged in while it is indexed and
+// never copied. A followed log is read on demand instead: truncated in
+// place, as by logrotate's copytruncate, its reads come back short where
+// touching a mapping would raise SIGBUS. The text of a compressed log comes
+// from its LogDecompressor
+class LogFile {
+   public:
+    enum class Access { Mapped, Read };
+
+    LogFile(const QString& fileName, Access access = Access::Mapped);
+    // open text of the compressed log fileName, as far as it is
+    // decompressed
+    LogFile(const QString& fileName,
+            std::shared_ptr<const LogDecompressor> decompressor);
+    ~LogFile();
+
+    LogFile(const LogFile&) = delete;
+    LogFile& operator=(const LogFile&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return m_isOpen; }
+
+    QString fileName() const { return m_file.fileName(); }
+    Access access() const { return m_access; }
+    // size when the file was opened
+    qint64 size() const;
+    // bytes [begin, end) clipped to size(), any thread may read. Bytes a
+    // truncated file no longer has read as zeros and set isTruncated(), a
+    // mapped file must not be truncated while its texts are in use
+    LogText text(std::uint64_t begin, std::uint64_t end) const;
+    // a read came back short, the file shrank since it was opened
+    bool isTruncated() const { return m_truncated; }
+
+   private:
+    // bytes per read, other threads get the file in between
+    static constexpr std::uint64_t MaxReadBytes = 4 * 1024 * 1024;
+
+    mutable QFile m_file;
+    mutable std::mutex m_mutex;  // of the file position
+    Access m_access;
+    qint64 m_size;
+    bool m_isOpen;
+    LogText m_mapped;  // the whole file, owning the mapping
+    mutable std::atomic<bool> m_truncated;
+    std::shared_ptr<const LogDecompressor> m_decompressor;
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <LogTable.h>
+#include <TimeIndex.h>
+#include <VisibleLines.h>
+
+#include <cstdint>
+#include <vector>
+
+// level/class/template filter over a LogTable, levels are a bit mask,
+// classes and templates bitsets indexed by id. Records are shown or hidden
+// as a whole, the records of every level, class and template are kept as
+// posting lists so toggling one checkbox only touches the records it
+// affects, "All" toggles fall back to a full vectorized pass over the rows.
+// Lines before the first record header pass every level filter
+class LogFilter {
+   public:
+    LogFilter();
+
+    // forgets the indexed table, everything checked
+    void reset();
+    // adds the rows of a table that extends the previously indexed one to
+    // the posting lists, checked levels, classes and templates are kept and
+    // new classes and templates start checked
+    void index(const LogTable& table);
+    // forgets the rows past a table that was truncated, the next index()
+    // evaluates its last record again
+    void truncate(const LogTable& table);
+
+    void setLevelChecked(LogLevel level, bool checked);
+    void setAllLevelsChecked(bool checked);
+    void setClassChecked(std::uint32_t classId, bool checked);
+    void setAllClassesChecked(bool checked);
+    void setTemplateChecked(std::uint32_t templateId, bool checked);
+    void setAllTemplatesChecked(bool checked);
+    // only records with a line whose bit is set in matches stay visible,
+    // the caller keeps matches covering every indexed row. nullptr shows
+    // all lines again
+    void setLineMatches(const std::vector<std::uint64_t>* matches);
+    // only lines with a time in [from, to] stay visible, the caller keeps
+    // timeIndex covering every indexed row. nullptr shows all lines again
+    void setTimeRange(const TimeIndex* timeIndex, std::int64_t from,
+                      std::int64_t to);
+
+    std::uint8_t levelMask() const { return m_levelMask; }
+    bool isLevelChecked(std::uint8_t level) const {
+        return level < 8 && (m_levelMask >> level) & 1;
+    }
+    bool isClassChecked(std::uint32_t classId) const {
+        return classId == LogTable::NoClass ||
+               (m_classBits[classId >> 6] >> (classId & 63)) & 1;
+    }
+    bool isTemplateChecked(std::uint32_t templateId) const {
+        return templateId >= m_templateCount ||
+               (m_templateBits[templateId >> 6] >> (templateId & 63)) & 1;
+    }
+    // true when a line of the record of line matches
+    bool isLineMatched(std::uint32_t line) const {
+        return m_lineMatches == nullptr ||
+               (m_recordMatches[line >> 6] >> (line & 63)) & 1;
+    }
+    bool isTimeMatched(std::uint32_t line) const {
+        return m_timeIndex == nullptr ||
+               m_timeIndex->isInRange(line, m_timeFrom, m_timeTo);
+    }
+
+    const VisibleLines& visibleLines() const { return m_visibleLines; }
+
+   private:
+    // ascending records of every level, class or template
+    using Postings = std::vector<std::vector<std::uint32_t>>;
+
+    std::size_t recordEnd(std::size_t record) const {
+        return record + 1 < m_records.size() ? m_records[record + 1]
+                                             : m_rowLevels.size();
+    }
+    // grows the template bitset and posting lists, new templates are
+    // checked
+    void addTemplates(std::uint32_t templateCount);
+    // sets or clears the lines of a record
+    void setRecordVisible(std::uint32_t record, bool visible);
+    // spreads the line matches of the records from firstRecord on to all
+    // of their lines
+    void matchRecords(std::size_t firstRecord);
+    // recomputes the visibility of the rows from firstRow on
+    void evaluate(std::size_t firstRow = 0);
+
+    std::uint8_t m_levelMask;
+    std::uint32_t m_classCount;
+    std::uint32_t m_uncheckedClassCount;
+    std::vector<std::uint64_t> m_classBits;
+    std::uint32_t m_templateCount;
+    std::uint32_t m_uncheckedTemplateCount;
+    std::vector<std::uint64_t> m_templateBits;
+    const std::vector<std::uint64_t>* m_lineMatches;
+    std::vector<std::uint64_t> m_recordMatches;  // line matches by record
+    const TimeIndex* m_timeIndex;
+    std::int64_t m_timeFrom;
+    std::int64_t m_timeTo;
+
+    // level, class and template of the record every row belongs to,
+    // continuation rows inherit them from their record header
+    std::vector<std::uint8_t> m_rowLevels;
+    std::vector<std::uint32_t> m_rowClasses;
+    std::vector<std::uint32_t> m_rowTemplates;
+    SnapshotVector<std::uint32_t> m_records;  // of the indexed table
+    std::size_t m_postedRecords;  // records added to the posting lists
+    Postings m_levelPostings;
+    Postings m_classPostings;
+    Postings m_templatePostings;
+
+    VisibleLines m_visibleLines;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <LogTable.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// number of record headers of every level per time bucket. The base
+// buckets are a power of two microseconds wide, starting at the time of
+// the first record, and are merged pairwise whenever the log spans more
+// than MaxBuckets of them. Every coarser level of the pyramid sums two
+// buckets of the level below, so any zoom reads one level without going
+// back to the rows
+class LogHistogram {
+   public:
+    using Counts = std::array<std::uint32_t, LogLevelCount>;
+    static constexpr std::size_t MaxBuckets = 64 * 1024;
+
+    LogHistogram();
+
+    void clear();
+    // counts the rows of a table that extends the previously counted one
+    void index(const LogTable& table);
+
+    bool empty() const { return m_pyramid.front().empty(); }
+    std::size_t rowCount() const { return m_rowCount; }
+    // time of the start of base bucket 0 and the end of the last one
+    std::int64_t begin() const { return m_origin; }
+    std::int64_t end() const {
+        auto buckets = static_cast<std::int64_t>(m_pyramid.front().size());
+        return m_origin + (buckets << m_shift);
+    }
+
+    // finest level whose buckets are at least width wide, the coarsest
+    // level when none is
+    std::size_t levelFor(std::int64_t width) const;
+    std::int64_t bucketWidth(std::size_t level) const {
+        return std::int64_t(1) << (m_shift + level);
+    }
+    const std::vector<Counts>& buckets(std::size_t level) const {
+        return m_pyramid[level];
+    }
+    std::size_t levelCount() const { return m_pyramid.size(); }
+
+   private:
+    // base buckets start one millisecond wide
+    static constexpr int InitialShift = 10;
+
+    // halves the base buckets, the merged level 1 becomes the base
+    void coarsen();
+    // sums the buckets of every coarser level from base bucket first on
+    void updatePyramid(std::size_t first);
+
+    std::size_t m_rowCount;
+    std::int64_t m_origin;
+    int m_shift;  // base buckets are 1 << m_shift microseconds wide
+    std::vector<std::vector<Counts>> m_pyramid;  // base buckets first
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <LogTable.h>
+
+#include <QCache>
+#include <QColor>
+#include <QFont>
+#include <QRegularExpression>
+#include <QStyledItemDelegate>
+#include <QTextLayout>
+#include <vector>
+
+// paints a log row as plain text with style runs for the timestamp, level
+// and class of its record header and a background behind search matches.
+// The first row of folded repeats is followed by their count and end time.
+// The laid out rows are cached by line so scrolling back and forth does not
+// shape the same text again
+class LogItemDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+   public:
+    enum class Field { Timestamp, Level, Class };
+    struct StyleRun {
+        int begin;
+        int length;
+        Field field;
+    };
+
+    LogItemDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option,
+                   const QModelIndex& index) const override;
+
+    // "[time][level] Class -- message", empty if text is no record header
+    static std::vector<StyleRun> styleRuns(const QString& text, bool hasClass);
+
+    // an invalid or empty expression highlights nothing
+    void setHighlight(const QRegularExpression& expression);
+
+   public slots:
+    void clearCache();
+
+   private:
+    static constexpr int CachedLayouts = 1024;
+
+    const QTextLayout* layout(const QStyleOptionViewItem& option,
+                              const QModelIndex& index) const;
+    QColor runColor(const StyleRun& run, LogLevel level) const;
+    // count and end time of the repeats a row folds, empty for other rows
+    static QString repeatBadge(const QModelIndex& index);
+
+    QColor m_timestampColor;
+    QColor m_classColor;
+    QColor m_highlightColor;
+    QColor m_repeatColor;
+    QRegularExpression m_highlight;
+
+    // keyed by line number in the file, laid out with m_layoutFont
+    mutable QCache<quint32, QTextLayout> m_layouts;
+    mutable QFont m_layoutFont;
+};
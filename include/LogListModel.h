@@ -0,0 +1,60 @@
+#pragma once
+#include <LogDocument.h>
+#include <RepeatFolder.h>
+#include <VisibleLines.h>
+
+#include <QAbstractListModel>
+#include <cstdint>
+#include <memory>
+
+// one row per visible log line, rows are resolved lazily through the line
+// index so only the rows on screen are ever decoded
+class LogListModel : public QAbstractListModel {
+    Q_OBJECT
+   public:
+    enum Role {
+        LineRole = Qt::UserRole + 1,  // line number in the file
+        LevelRole,                    // LogLevel of a record header line
+        ClassRole,                    // class id of a record header line
+        RepeatCountRole,     // records of the repeat run a row starts
+        RepeatEndRole,       // time of the last record of the run
+        RepeatExpandedRole,  // the records of the run are shown
+    };
+
+    LogListModel(QObject* parent = nullptr);
+
+    void clear();
+    // a document of the shown generation that grew while loading or
+    // following appends rows when the shown rows stay visible as they are,
+    // any other document replaces the rows
+    void setLogDocument(std::shared_ptr<const LogDocument> document,
+                        std::shared_ptr<const VisibleLines> lines,
+                        std::shared_ptr<const RepeatRuns> runs);
+    // other lines of the shown document, rows the view keeps follow their
+    // lines
+    void setFilteredLines(std::shared_ptr<const LogDocument> document,
+                          std::shared_ptr<const VisibleLines> lines,
+                          std::shared_ptr<const RepeatRuns> runs);
+
+    const std::shared_ptr<const LogDocument>& document() const {
+        return m_document;
+    }
+    std::uint32_t lineAt(int row) const { return m_lines->lineAt(row); }
+    // row of line, or of the first visible line after it
+    int rowOf(std::uint32_t line) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+   private:
+    // other visible lines of m_document, the rows keep their lines
+    void replaceLines(std::shared_ptr<const VisibleLines> lines,
+                      std::shared_ptr<const RepeatRuns> runs);
+    // run starting at line, nullptr if there is none
+    const RepeatRun* runAt(std::uint32_t line) const;
+
+    std::shared_ptr<const LogDocument> m_document;
+    std::shared_ptr<const VisibleLines> m_lines;  // lines of m_document
+    std::shared_ptr<const RepeatRuns> m_runs;     // nullptr unless folded
+};
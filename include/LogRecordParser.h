@@ -0,0 +1,37 @@
+#pragma once
+#include <LineIndex.h>
+#include <LogTable.h>
+#include <LogText.h>
+
+#include <cstdint>
+#include <string_view>
+
+// hand written single pass parser for the spdlog pattern used by our
+// applications: "[YYYY-mm-dd HH:MM:SS.mmm][level] Class -- message"
+// lines without that header are continuation lines of the previous record
+class LogRecordParser {
+   public:
+    LogRecordParser(LogTable& table);
+
+    // appends one row per line in [firstLine, lastLine) to the table, text
+    // holds the lines
+    void parse(const LogText& text, const LineIndex& lineIndex,
+               std::uint64_t firstLine, std::uint64_t lastLine);
+
+   private:
+    struct Header {
+        std::int64_t timestamp;
+        std::uint8_t level;
+        std::string_view className;
+        const char* message;
+    };
+
+    static bool parseHeader(const char* begin, const char* end,
+                            Header& header);
+    static bool parseTimestamp(const char*& current, const char* end,
+                               std::int64_t& timestamp);
+    static std::uint8_t parseLevel(std::string_view level);
+
+    LogTable& m_table;
+    std::int64_t m_lastTimestamp;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <LineIndex.h>
+#include <LiteralFinder.h>
+#include <LogFile.h>
+#include <LogText.h>
+#include <ThreadPool.h>
+#include <TrigramIndex.h>
+
+#include <QRegularExpression>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// text or regular expression search over the lines of a log. The trigram
+// index narrows the search to candidate blocks of 64 lines, lines it does
+// not cover are all scanned. Blocks are read and searched on the raw bytes
+// in parallel, a regular expression only runs on lines containing its
+// required literal. Matches are kept as a bitmap by line and extended as
+// more lines are loaded
+class LogSearch {
+   public:
+    LogSearch(ThreadPool& pool);
+
+    // an empty text ends the search. Without matchCase text searches
+    // ignore the case of ASCII letters, regular expressions of all letters.
+    // Returns false for an invalid regular expression, which ends the search
+    bool setQuery(const std::string& text, bool matchCase, bool isRegex);
+    bool isActive() const { return m_active; }
+    // forgets the searched lines of the previous file, keeps the query
+    void reset();
+    // forgets the searched lines from lineCount on
+    void truncate(std::size_t lineCount);
+
+    // searches the lines of lineIndex that were not searched yet. They are
+    // taken from loaded where it holds them and read from file otherwise
+    void update(const LogFile& file, const LogText& loaded,
+                const LineIndex& lineIndex, const TrigramIndex& index);
+
+    std::size_t lineCount() const { return m_lineCount; }
+    // bit i of word i / 64 is set when line i matches
+    const std::vector<std::uint64_t>& matches() const { return m_matches; }
+
+   private:
+    // candidate blocks verified by one task
+    static constexpr std::size_t BlocksPerTask = 64;
+
+    void searchBlock(const LogText& text, const LineIndex& lineIndex,
+                     const QRegularExpression& regex, std::size_t firstLine,
+                     std::size_t lastLine);
+
+    ThreadPool& m_pool;
+    bool m_active;
+    bool m_isRegex;
+    QRegularExpression m_regex;  // compiled once per query
+    LiteralFinder m_finder;      // the text or the required literal
+    std::size_t m_lineCount;
+    std::vector<std::uint64_t> m_matches;
+};
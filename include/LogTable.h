@@ -0,0 +1,70 @@
+#pragma once
+#include <ClassDictionary.h>
+#include <IndexStream.h>
+#include <SnapshotVector.h>
+
+#include <array>
+#include <cstdint>
+
+enum class LogLevel { TRACE, DEBUG, INFO, WARNING, ERROR, CRITICAL };
+constexpr std::size_t LogLevelCount = 6;
+using LevelCounts = std::array<std::uint64_t, LogLevelCount>;
+// name and 0xrrggbb color of every LogLevel, shared by the checkboxes, the
+// rows and the timeline
+constexpr std::array<const char*, LogLevelCount> LogLevelNames = {
+    "trace", "debug", "info", "warning", "error", "critical"};
+constexpr std::array<std::uint32_t, LogLevelCount> LogLevelColors = {
+    0xa0a0a4, 0x0000ff, 0x008000, 0x808000, 0xff0000, 0x800000};
+
+// parsed log lines stored column by column, row i describes line i of the
+// log file so every column can be scanned without touching the text. A
+// record is a header row with the continuation rows that follow it, the
+// record table keeps the first row of every record. Copies are snapshots
+// that share the columns
+struct LogTable {
+    static constexpr std::uint8_t NoLevel = 0xff;  // no record header
+    static constexpr std::uint32_t NoClass = ClassDictionary::NoId;
+    static constexpr std::uint32_t NoTemplate = 0xffffffff;
+
+    SnapshotVector<std::int64_t> timestamps;  // microseconds since epoch
+    SnapshotVector<std::uint8_t> levels;      // LogLevel or NoLevel
+    SnapshotVector<std::uint32_t> classIds;   // id in classes or NoClass
+    SnapshotVector<std::uint64_t> messageOffsets;  // byte offset in the file
+    SnapshotVector<std::uint32_t> messageLengths;
+    // ascending first rows of the records, rows before the first header
+    // are a record of their own
+    SnapshotVector<std::uint32_t> records;
+    // template id of every record or NoTemplate for records without
+    // header, filled in by TemplateMiner after parsing
+    SnapshotVector<std::uint32_t> templateIds;
+
+    ClassDictionary classes;
+
+    std::size_t size() const { return levels.size(); }
+    std::size_t recordCount() const { return records.size(); }
+    // record spans the rows [recordBegin(record), recordEnd(record))
+    std::size_t recordBegin(std::size_t record) const {
+        return records[record];
+    }
+    std::size_t recordEnd(std::size_t record) const {
+        return record + 1 < records.size() ? records[record + 1] : size();
+    }
+    std::size_t recordOf(std::size_t row) const;
+    void reserve(std::size_t rows);
+    void clear();
+    // keeps the first rows, a record losing its header is dropped with its
+    // template id. Interned classes stay
+    void truncate(std::size_t rows);
+    // appends the rows of a table parsed from the lines that follow this
+    // one, its class ids are translated into this dictionary and the
+    // continuation rows it starts with take the time of the last row here
+    // and belong to its last record
+    void append(const LogTable& next);
+    // load uses the saved columns in place and fails the reader when
+    // their sizes disagree or a row refers past the dictionary, the records
+    // or the textSize bytes of the log
+    void save(IndexWriter& writer) const;
+    void load(IndexReader& reader, std::uint64_t textSize);
+    // adds the number of record headers of every level in [firstRow, size())
+    void countLevels(std::size_t firstRow, LevelCounts& counts) const;
+};
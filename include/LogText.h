@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+// bytes [begin(), end()) of a log, addressed by their offsets in the whole
+// log as the line index and the table columns count them. A text shares
+// the buffer it was read into, which stays valid as long as any copy of
+// the text
+class LogText {
+   public:
+    LogText() : m_data(nullptr), m_begin(0), m_end(0) {}
+    LogText(const char* data, std::uint64_t begin, std::uint64_t end,
+            std::shared_ptr<const void> owner = nullptr)
+        : m_data(data), m_begin(begin), m_end(end), m_owner(std::move(owner)) {}
+    // all of text from offset 0, which the caller keeps alive
+    explicit LogText(std::string_view text)
+        : LogText(text.data(), 0, text.size()) {}
+
+    std::uint64_t begin() const { return m_begin; }
+    std::uint64_t end() const { return m_end; }
+    std::uint64_t size() const { return m_end - m_begin; }
+    const char* data() const { return m_data; }
+    bool contains(std::uint64_t begin, std::uint64_t end) const {
+        return begin >= m_begin && end <= m_end;
+    }
+
+    // the byte at offset, which lies in [begin(), end()]
+    const char* at(std::uint64_t offset) const {
+        return m_data + (offset - m_begin);
+    }
+    std::uint64_t offsetOf(const char* position) const {
+        return m_begin + static_cast<std::uint64_t>(position - m_data);
+    }
+    std::string_view view(std::uint64_t begin, std::uint64_t end) const {
+        return std::string_view(at(begin), end - begin);
+    }
+    // [begin, end) within this text, sharing its buffer
+    LogText slice(std::uint64_t begin, std::uint64_t end) const {
+        return LogText(at(begin), begin, end, m_owner);
+    }
+
+   private:
+    const char* m_data;
+    std::uint64_t m_begin;
+    std::uint64_t m_end;
+    std::shared_ptr<const void> m_owner;
+};
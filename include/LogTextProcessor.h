@@ -1,63 +1,201 @@
 #pragma once
-#include <QButtonGroup>
-#include <QCheckBox>
+#include <IndexFile.h>
+#include <LineIndex.h>
+#include <LogDecompressor.h>
+#include <LogDocument.h>
+#include <LogFile.h>
+#include <LogFilter.h>
+#include <LogSearch.h>
+#include <LogTable.h>
+#include <ParallelLogParser.h>
+#include <RepeatFolder.h>
+#include <TemplateMiner.h>
+#include <ThreadPool.h>
+#include <TimeIndex.h>
+#include <TrigramIndex.h>
+#include <VisibleLines.h>
+
+#include <QFileSystemWatcher>
 #include <QObject>
-#include <QWidget>
+#include <QString>
+#include <QTimer>
+#include <cstdint>
+#include <memory>
 #include <set>
-enum class LogLevel { TRACE, DEBUG, INFO, WARNING, ERROR, CRITICAL };
+#include <string>
+#include <vector>
+
+// row of the template list
+struct TemplateSummary {
+    QString text;  // class and message with <*> for the varying tokens
+    quint64 count;
+    qint64 first;  // time of the first and last record
+    qint64 last;
+    bool checked;
+};
 
 class LogTextProcessor : public QObject {
     Q_OBJECT
    public:
-    LogTextProcessor(QWidget* parent = nullptr);
+    LogTextProcessor(QObject* parent = nullptr);
     ~LogTextProcessor();
 
-    QString getLogText() const { return m_logTextHtml; }
-    std::map<LogLevel, QString> getLevels() const { return m_levels; }
-    QButtonGroup* getLevelChoiceGroup() const { return m_levelChoiceGroup; }
-
    signals:
-    void updateClassCheckBoxes(const std::vector<QCheckBox*>& classCheckBoxes);
-    void updateLevelCheckBoxes(const std::vector<QCheckBox*>& levelCheckBoxes);
-    void logTextLoaded(const QString& logTextHtml);
-    void logTextProcessed(const QString& logTextHtml);
+    // class names and their checked state are indexed by class id
+    void updateClassCheckBoxes(const std::vector<QString>& classNames,
+                               const std::vector<bool>& checked);
+    // bit i of levelMask is set when LogLevel i is checked
+    void updateLevelCheckBoxes(const std::vector<LogLevel>& levels,
+                               std::uint8_t levelMask);
+    // templates are indexed by template id, ids stay the same while a file
+    // is loading
+    void updateTemplates(const std::vector<TemplateSummary>& templates);
+    void logFileLoaded(std::shared_ptr<const LogFile> logFile);
+    void logLoadingProgress(qint64 loadedBytes, qint64 totalBytes);
+    // lines of a document extending the previous one, visible under the
+    // same filter. runs are the folded repeats, nullptr unless folding
+    void logDocumentLoaded(std::shared_ptr<const LogDocument> document,
+                           std::shared_ptr<const VisibleLines> lines,
+                           std::shared_ptr<const RepeatRuns> runs);
+    // lines of document that pass the changed filter
+    void logLinesFiltered(std::shared_ptr<const LogDocument> document,
+                          std::shared_ptr<const VisibleLines> lines,
+                          std::shared_ptr<const RepeatRuns> runs);
+
+    void levelFilterChanged(LogLevel level, bool checked);
+    void allLevelsFilterChanged(bool checked);
+    void classFilterChanged(std::uint32_t classId, bool checked);
+    void allClassesFilterChanged(bool checked);
+    void templateFilterChanged(quint32 templateId, bool checked);
+    void allTemplatesFilterChanged(bool checked);
+    void followModeChanged(bool follow);
+    void searchChanged(const QString& text, bool matchCase, bool isRegex);
+    void searchIndexChanged(bool enabled);
+    void timeRangeChanged(bool enabled, qint64 from, qint64 to);
+    void foldRepeatsChanged(bool fold);
+    void repeatRunExpanded(quint32 line, bool expanded);
 
    public slots:
-    void setLogText(const QString& logTextHtml);
+    void setLogFile(std::shared_ptr<const LogFile> logFile);
+    // keeps loading what is appended to the file, a truncated or replaced
+    // file is loaded again from the start
+    void setFollowMode(bool follow);
+    // shows only lines containing text or matching it as a regular
+    // expression, an empty text shows all lines
+    void setSearch(const QString& text, bool matchCase, bool isRegex);
+    // without the trigram index searches scan every line, which saves the
+    // memory and loading time of the index
+    void setSearchIndex(bool enabled);
+    // shows only lines logged in [from, to], microseconds since epoch
+    void setTimeRange(bool enabled, qint64 from, qint64 to);
+    // shows runs of records with the same message template as one row
+    void setFoldRepeats(bool fold);
+    // shows every record of the run starting at line, or folds it again
+    void setRepeatExpanded(quint32 line, bool expanded);
+    void setLevelFilter(LogLevel level, bool checked);
+    void setAllLevelsFilter(bool checked);
+    void setClassFilter(std::uint32_t classId, bool checked);
+    void setAllClassesFilter(bool checked);
+    void setTemplateFilter(quint32 templateId, bool checked);
+    void setAllTemplatesFilter(bool checked);
 
    private:
-    void createLevelButtons();
-
-    // void updateSideBarFiltersFromFile();
-    void updateLogViewFromFile();
+    // the first chunk is small so the first page shows up right away,
+    // later ones give every thread of the pool a few megabytes
+    static constexpr std::uint64_t FirstChunkBytes = 256 * 1024;
+    static constexpr std::uint64_t ChunkBytesPerThread = 8 * 1024 * 1024;
+    // bytes compared to tell a grown file from a replaced one
+    static constexpr std::uint64_t HeadBytes = 4096;
+    // text read at once when an index catches up with the loaded lines
+    static constexpr std::uint64_t SliceBytes = 64 * 1024 * 1024;
+    // file change notifications within this time are handled once
+    static constexpr int FollowDelayMs = 100;
+    // smaller logs are parsed again instead of getting a sidecar index, a
+    // sidecar is written again once this many more bytes were indexed
+    static constexpr std::uint64_t MinIndexFileBytes = 64 * 1024 * 1024;
 
+    void startLoading(std::shared_ptr<const LogFile> logFile);
+    // one chunk per event, filter changes and newer files are handled in
+    // between
+    void scheduleNextChunk();
+    void loadNextChunk(std::uint64_t generation);
+    // loaded is the text of the lines added since the last document
+    void publishDocument(const LogText& loaded, bool complete);
+    void saveIndexFile();
+    // the trigram index and repeat keys of the lines they miss, taken from
+    // loaded or read from the file
+    void indexSearchText(const LogText& loaded);
+    void indexRepeats(const LogText& loaded);
+    // whole lines from line on, loaded if it holds the first one or about
+    // SliceBytes read from the file
+    LogText linesFrom(std::uint64_t line, const LogText& loaded) const;
+    void watchFile();
+    // takes the last line without line ending back out of every index, so
+    // following parses it again once it ends
+    void reopenLastLine();
+    void checkFileGrowth();
+    // opens the source again and loads it from the start, after it was
+    // truncated
+    void loadAgain();
+    // remembers the unchecked levels, classes and templates before a
+    // followed file is loaded again
+    void keepFilter();
+    // unchecks the kept ones as they show up in the loaded lines, other
+    // levels start checked when they are found
+    void restoreFilter();
     void updateLevelFilterFromFile();
     void updateClassFilterFromFile();
+    void updateTemplatesFromFile();
+    // class and message of a template as the template list shows it
+    QString templateText(std::uint32_t id) const;
 
     // general functions
-    void filterLogText(QString& logTextHtml);
-    void filterLogText(QString& logTextHtml, const std::set<QString>& classes,
-                       const std::set<QString>& levels);
-    void showLevelInDifferentColor(QString& logTextHtml);
+    void filterLogText();
+    // snapshots of the lines and runs shown under the current filter
+    std::shared_ptr<const VisibleLines> shownLines() const;
+    std::shared_ptr<const RepeatRuns> shownRuns() const;
 
     // utils
-    bool getLogLevelFromString(const QString& level, LogLevel& logLevel);
     QString capitalize(const QString& str);
 
-    QWidget* m_parent;
-    QString m_logTextHtml;
-    QString m_logTextHtmlBackup;
-    const QString m_levelReg = "\\[(\\w+)\\]";
-    const QString m_classReg = "\\s*(\\w+)\\s*-";
-
-    std::set<QString> m_classes;
-    std::set<QString> m_classesFromLog;
-    std::set<QString> m_levelsFromLog;
-    std::map<LogLevel, QString> m_levels;
-    std::map<LogLevel, QColor> m_levelColors;
-
-    QButtonGroup* m_levelChoiceGroup;
-    QButtonGroup* m_classChoiceGroup;
-    std::map<QString, QCheckBox*> m_classCheckBoxes;
-    std::map<LogLevel, QCheckBox*> m_levelCheckBoxes;
-};
\ No newline at end of file
+    std::shared_ptr<const LogFile> m_source;   // file opened by the ui
+    std::shared_ptr<const LogFile> m_logFile;  // size being loaded
+    // text of a compressed source, which m_logFile reads
+    std::shared_ptr<LogDecompressor> m_decompressor;
+    std::uint64_t m_generation;  // incremented for every load from the start
+    std::uint64_t m_loadedBytes;
+    std::uint64_t m_indexFileBytes;  // indexed bytes the sidecar holds
+    bool m_loading;
+    bool m_follow;
+    // created on the processor thread when following starts
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_followTimer;
+    // index and columns of the lines loaded so far, copies published with
+    // every chunk share them
+    LineIndex m_lineIndex;
+    LogTable m_logTable;
+    LevelCounts m_levelCounts;
+    bool m_searchIndex;
+    TrigramIndex m_trigramIndex;
+    TimeIndex m_timeIndex;
+    bool m_timeRange;
+    std::int64_t m_timeFrom;
+    std::int64_t m_timeTo;
+    bool m_foldRepeats;
+    RepeatFolder m_repeatFolder;
+    TemplateMiner m_templateMiner;
+    std::shared_ptr<const LogDocument> m_document;  // last published
+
+    LogFilter m_logFilter;
+    // checkboxes kept by name while a followed file is loaded again, its
+    // ids change. Entries are dropped once they were applied
+    std::uint8_t m_keptLevels;  // bits of the unchecked levels
+    std::set<std::string> m_keptClasses;
+    std::set<QString> m_keptTemplates;
+    std::uint8_t m_foundLevels;    // levels found since loading started
+    std::uint32_t m_foundClasses;  // classes looked up in m_keptClasses
+
+    ThreadPool m_threadPool;
+    ParallelLogParser m_parser;
+    LogSearch m_search;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <QAbstractItemDelegate>
+#include <QAbstractItemModel>
+#include <QAbstractScrollArea>
+#include <QPersistentModelIndex>
+
+// scroll area that paints only the rows inside the viewport, every row has
+// the same height so scrolling never needs to lay out the whole model
+class LogView : public QAbstractScrollArea {
+    Q_OBJECT
+   public:
+    LogView(QWidget* parent = nullptr);
+
+    void setModel(QAbstractItemModel* model);
+    QAbstractItemModel* model() const { return m_model; }
+    void setItemDelegate(QAbstractItemDelegate* delegate);
+    QAbstractItemDelegate* itemDelegate() const { return m_delegate; }
+
+    int currentRow() const { return m_currentRow; }
+    void setCurrentRow(int row);
+    void scrollToRow(int row);
+    void scrollToBottom();
+
+   signals:
+    // a row was double clicked or Enter was pressed on it
+    void rowActivated(int row);
+
+   protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+
+   private slots:
+    void updateScrollBars();
+    void resetView();
+    // rows of the current line, the selection anchor and the top line kept
+    // across a layout change of the model
+    void saveRows();
+    void restoreRows();
+
+   private:
+    int rowHeight() const;
+    int visibleRowCount() const;
+    int rowAt(int y) const;
+    bool isRowSelected(int row) const;
+    void copySelection();
+
+    QAbstractItemModel* m_model;
+    QAbstractItemDelegate* m_delegate;
+    int m_currentRow;
+    int m_selectionAnchor;
+    int m_maxRowWidth;  // widest row painted so far
+    QPersistentModelIndex m_savedCurrent;
+    QPersistentModelIndex m_savedAnchor;
+    QPersistentModelIndex m_savedTop;
+};
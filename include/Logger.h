@@ -1,3 +1,5 @@
+#pragma once
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>  // or "../stdout_sinks.h" if no colors needed
 #include <spdlog/spdlog.h>
@@ -16,12 +18,26 @@
     SPDLOG_LOGGER_CRITICAL(spdlog::default_logger_raw(), __VA_ARGS__)
 
 #include <chrono>
+#include <cstddef>
 #include <ctime>
 #include <filesystem>
 #include <string>
 
 namespace spdlog {
-inline void init_logger() {
+// async: messages are queued and written by one background thread, a full
+// queue drops the oldest message instead of blocking the caller. Files are
+// flushed every flushInterval and on messages of flushLevel and above.
+// sync: every message is written and flushed by the calling thread
+struct LoggerOptions {
+    bool async = true;
+    std::size_t queueSize = 8192;
+    async_overflow_policy overflowPolicy =
+        async_overflow_policy::overrun_oldest;
+    std::chrono::seconds flushInterval{1};
+    level::level_enum flushLevel = level::warn;
+};
+
+inline void init_logger(const LoggerOptions &options = LoggerOptions()) {
     auto now = std::chrono::system_clock::now();
     std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
     std::tm *localTime = std::localtime(&currentTime);
@@ -45,17 +61,26 @@ inline void init_logger() {
         "[%Y-%m-%d %T.%e][%^%l%$][thread %t][file:%s - line:%#] %v");
 
     // set multi_sink logger as default logger
-    spdlog::set_default_logger(
-        std::make_shared<spdlog::logger>("multi_sink", spdlog::sinks_init_list({
-                                                           consoleSink,
-                                                           fileSink,
-                                                           developerSink,
-                                                       })));
+    spdlog::sinks_init_list sinks({consoleSink, fileSink, developerSink});
+    if (options.async) {
+        spdlog::init_thread_pool(options.queueSize, 1);
+        spdlog::set_default_logger(std::make_shared<spdlog::async_logger>(
+            "multi_sink", sinks, spdlog::thread_pool(),
+            options.overflowPolicy));
+    } else {
+        spdlog::set_default_logger(
+            std::make_shared<spdlog::logger>("multi_sink", sinks));
+    }
     spdlog::set_level(spdlog::level::trace);
     consoleSink->set_level(spdlog::level::debug);
     fileSink->set_level(spdlog::level::trace);
     developerSink->set_level(spdlog::level::trace);
-    spdlog::flush_on(spdlog::level::trace);
+    if (options.async) {
+        spdlog::flush_on(options.flushLevel);
+        spdlog::flush_every(options.flushInterval);
+    } else {
+        spdlog::flush_on(spdlog::level::trace);
+    }
 };
 }  // namespace spdlog
 namespace Logger = spdlog;
\ No newline at end of file
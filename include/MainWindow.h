@@ -1,17 +1,31 @@
 
 #pragma once
 
+#include <LogFile.h>
+#include <LogItemDelegate.h>
+#include <LogListModel.h>
 #include <LogTextProcessor.h>
+#include <LogView.h>
+#include <TimelineWidget.h>
 
 #include <QAction>
+#include <QButtonGroup>
+#include <QCheckBox>
+#include <QDateTimeEdit>
 #include <QFileInfo>
 #include <QLabel>
+#include <QLineEdit>
 #include <QMainWindow>
+#include <QProgressBar>
+#include <QRegularExpression>
 #include <QString>
-#include <QTextEdit>
 #include <QThread>
+#include <QTimer>
+#include <QTreeWidget>
 #include <QVBoxLayout>
+#include <memory>
 #include <set>
+#include <vector>
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -24,10 +38,30 @@ class MainWindow : public QMainWindow {
     void openFile();
     void closeFile();
 
-    void updateLevelCheckBoxes(const std::vector<QCheckBox*>& levelCheckBoxes);
-    void updateClassCheckBoxes(const std::vector<QCheckBox*>& classCheckBoxes);
+    void updateLevelCheckBoxes(const std::vector<LogLevel>& levels,
+                               std::uint8_t levelMask);
+    void updateClassCheckBoxes(const std::vector<QString>& classNames,
+                               const std::vector<bool>& checked);
+    void levelCheckBoxClicked(int id);
+    void classCheckBoxClicked(int id);
+    void updateTemplateList(const std::vector<TemplateSummary>& templates);
+    void templateItemChanged(QTreeWidgetItem* item, int column);
+    void allTemplatesClicked(bool checked);
 
-    void updateLogText(const QString& logTextHtml);
+    void updateLogDocument(std::shared_ptr<const LogDocument> document,
+                           std::shared_ptr<const VisibleLines> lines,
+                           std::shared_ptr<const RepeatRuns> runs);
+    void updateLoadingProgress(qint64 loadedBytes, qint64 totalBytes);
+    void updateLogLines(std::shared_ptr<const LogDocument> document,
+                        std::shared_ptr<const VisibleLines> lines,
+                        std::shared_ptr<const RepeatRuns> runs);
+    // expands or folds the repeats a row starts
+    void toggleRepeatRun(int row);
+    void searchLogText();
+    void filterTimeRange();
+    void goToTime();
+    // selects the first visible line logged at or after time
+    void showTime(qint64 time);
 
    private:
     // creating ui
@@ -38,7 +72,10 @@ class MainWindow : public QMainWindow {
 
     void createCentralWidget();
     QWidget* createSideBar();
+    QWidget* createTemplateList();
     QWidget* createLogView();
+    QWidget* createSearchBar();
+    QWidget* createTimeBar();
 
     void showHelpDialog();
     void showAboutDialog();
@@ -46,10 +83,24 @@ class MainWindow : public QMainWindow {
 
     // update ui from file
     void updateLogFileNameFromFile();
+    void updateAllCheckBox(QButtonGroup* choiceGroup);
+    void updateAllTemplatesBox();
 
     QFileInfo* m_currentLog;
+    std::shared_ptr<const LogFile> m_logFile;
     QLabel* m_logFileName;
-    QTextEdit* m_logText;
+    QProgressBar* m_loadingProgress;
+    QLineEdit* m_searchEdit;
+    QCheckBox* m_matchCaseBox;
+    QCheckBox* m_regexBox;
+    QTimer* m_searchTimer;  // searches once typing pauses
+    QCheckBox* m_timeRangeBox;
+    QDateTimeEdit* m_timeFromEdit;
+    QDateTimeEdit* m_timeToEdit;
+    LogView* m_logView;
+    TimelineWidget* m_timeline;
+    LogItemDelegate* m_logDelegate;
+    LogListModel* m_logModel;
     LogTextProcessor* m_logTextProcessor;
     QThread* m_logTextProcessorThread;
 
@@ -57,8 +108,19 @@ class MainWindow : public QMainWindow {
     QAction* m_aboutAction;
     QAction* m_openAction;
     QAction* m_closeAction;
+    QAction* m_followAction;
+    QAction* m_findAction;
+    QAction* m_goToTimeAction;
+    QAction* m_foldRepeatsAction;
+    QAction* m_searchIndexAction;
 
     QVBoxLayout* m_levelCheckBoxLayout;
     QVBoxLayout* m_classCheckBoxLayout;
-    std::vector<QCheckBox*> m_previousClassCheckBoxes;
+    // button id 0 is "All", level buttons use LogLevel + 1 and class buttons
+    // use class id + 1
+    QButtonGroup* m_levelChoiceGroup;
+    QButtonGroup* m_classChoiceGroup;
+    QCheckBox* m_allTemplatesBox;
+    QTreeWidget* m_templateList;
+    std::vector<QTreeWidgetItem*> m_templateItems;  // by template id
 };
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <LineIndex.h>
+#include <LogTable.h>
+#include <LogText.h>
+#include <ThreadPool.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// indexes and parses log text on a thread pool. The bytes are split into
+// newline aligned chunks, every chunk gets its own line index, table and
+// level counts, and the results are merged in file order so the outcome
+// does not depend on the number of threads
+class ParallelLogParser {
+   public:
+    ParallelLogParser(ThreadPool& pool);
+
+    // indexes and parses the lines in [lineIndex.indexedSize(), text.end()),
+    // the last line without line ending is only taken when atEnd is set
+    void parse(const LogText& text, bool atEnd, LineIndex& lineIndex,
+               LogTable& table, LevelCounts& levelCounts);
+
+   private:
+    static constexpr std::uint64_t MinChunkBytes = 1024 * 1024;
+    // more chunks than threads so stealing can even out slow chunks
+    static constexpr std::size_t ChunksPerThread = 4;
+
+    ThreadPool& m_pool;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// literal analysis of PCRE patterns for prefiltering lines before the
+// regular expression runs
+namespace RegexLiteral {
+// longest run of literal bytes that every match of pattern contains, empty
+// when there is none or the pattern uses syntax this does not follow
+// (alternation, inline options, quoting, code point escapes). Without
+// matchCase only ASCII bytes are part of runs, the prefilter folds ASCII
+// letters only
+std::string required(std::string_view pattern, bool matchCase);
+}  // namespace RegexLiteral
@@ -0,0 +1,64 @@
+#pragma once
+#include <LogTable.h>
+#include <LogText.h>
+#include <VisibleLines.h>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+// consecutive visible records with the same message template, shown as
+// the row of their first record
+struct RepeatRun {
+    std::uint32_t line;      // first line of the first record
+    std::uint32_t lastLine;  // first line of the last record
+    std::uint32_t count;     // records in the run
+    bool expanded;           // every record of the run stays visible
+};
+using RepeatRuns = std::vector<RepeatRun>;  // ascending lines
+
+// folds runs of repeated records out of the visible lines. The template of
+// a record hashes its level, class and message with every token containing
+// a digit masked, so polling lines that only differ in numbers and ids
+// fold together. Templates are hashed once per record while loading and
+// folding is a single pass over the records
+class RepeatFolder {
+   public:
+    RepeatFolder();
+
+    // forgets the templates and the expanded runs
+    void reset();
+    // hashes the templates of the records that are not hashed yet, up to
+    // the first one whose message does not end within text
+    void index(const LogText& text, const LogTable& table);
+    // forgets the records from recordCount on, extend() folds the last run
+    // again
+    void truncate(std::size_t recordCount);
+    std::size_t indexedRecords() const { return m_keys.size(); }
+
+    // folds the visible lines of the table from the start
+    void fold(const VisibleLines& visible, const LogTable& table);
+    // folds the lines a grown table added to the previously folded ones,
+    // visible must come from the same filter
+    void extend(const VisibleLines& visible, const LogTable& table);
+    // the run starting at line stays expanded until the next reset
+    void setExpanded(std::uint32_t line, bool expanded);
+
+    const VisibleLines& visibleLines() const { return m_folded; }
+    const RepeatRuns& runs() const { return m_runs; }
+
+   private:
+    static std::uint64_t templateKey(std::uint8_t level,
+                                     std::uint32_t classId,
+                                     const char* begin, const char* end);
+    // folds the records from firstRecord on, the lines before it are done
+    void foldRecords(const VisibleLines& visible, const LogTable& table,
+                     std::size_t firstRecord);
+
+    std::vector<std::uint64_t> m_keys;   // template of every record
+    std::set<std::uint32_t> m_expanded;  // first lines of expanded runs
+    VisibleLines m_folded;
+    RepeatRuns m_runs;
+    // first record of the last run, later records may still join it
+    std::size_t m_resumeRecord;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+// x86-64 vector helpers shared by the scanning code, SSE2 is always available
+// there, AVX2 paths are compiled with a function level target attribute and
+// only used when the cpu supports them
+#if defined(__x86_64__) || defined(_M_X64)
+#define LOGREADER_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LOGREADER_TARGET_AVX2
+#else
+#define LOGREADER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace Simd {
+bool hasAvx2();
+
+inline int countTrailingZeros(std::uint32_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+inline int countTrailingZeros64(std::uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+inline int popCount64(std::uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<int>(__popcnt64(value));
+#else
+    return __builtin_popcountll(value);
+#endif
+}
+}  // namespace Simd
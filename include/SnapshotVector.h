@@ -0,0 +1,178 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// growable array whose copies are cheap snapshots. A copy shares the
+// storage and only sees the elements that existed when it was made, the
+// original keeps appending behind them in place. Elements that a copy can
+// see are never written again, changing or removing them copies the storage
+// first. Only one of the vectors sharing a storage should be modified, the
+// others are read-only snapshots that may be read from any thread
+template <typename T>
+class SnapshotVector {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "elements are copied with std::copy_n");
+
+   public:
+    using value_type = T;
+    using const_iterator = const T*;
+
+    SnapshotVector() : m_size(0) {}
+    // read-only view of size elements at data that owner keeps alive, e.g.
+    // a mapped file. The elements count as seen by a snapshot, so changing
+    // or appending copies them first
+    static SnapshotVector view(const T* data, std::size_t size,
+                               std::shared_ptr<const void> owner) {
+        SnapshotVector vector;
+        if (size == 0) {
+            return vector;
+        }
+        auto storage = std::make_shared<Storage>();
+        storage->data = const_cast<T*>(data);
+        storage->owner = std::move(owner);
+        storage->capacity = size;
+        storage->used = size;
+        storage->frozen = size;
+        vector.m_storage = std::move(storage);
+        vector.m_size = size;
+        return vector;
+    }
+    SnapshotVector(const SnapshotVector& other)
+        : m_storage(other.m_storage), m_size(other.m_size) {
+        freeze();
+    }
+    SnapshotVector(SnapshotVector&& other) noexcept
+        : m_storage(std::move(other.m_storage)), m_size(other.m_size) {
+        other.m_size = 0;
+    }
+    SnapshotVector& operator=(const SnapshotVector& other) {
+        m_storage = other.m_storage;
+        m_size = other.m_size;
+        freeze();
+        return *this;
+    }
+    SnapshotVector& operator=(SnapshotVector&& other) noexcept {
+        m_storage = std::move(other.m_storage);
+        m_size = other.m_size;
+        other.m_size = 0;
+        return *this;
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::size_t capacity() const {
+        return m_storage == nullptr ? 0 : m_storage->capacity;
+    }
+    const T* data() const {
+        return m_storage == nullptr ? nullptr : m_storage->data;
+    }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + m_size; }
+    const T& operator[](std::size_t index) const {
+        return m_storage->data[index];
+    }
+    const T& front() const { return m_storage->data[0]; }
+    const T& back() const { return m_storage->data[m_size - 1]; }
+
+    void reserve(std::size_t capacity) {
+        if (capacity > this->capacity()) {
+            reallocate(capacity);
+        }
+    }
+    void push_back(T value) {
+        prepareAppend(m_size + 1);
+        m_storage->data[m_size++] = value;
+        m_storage->used = m_size;
+    }
+    void append(const T* first, const T* last) {
+        auto count = static_cast<std::size_t>(last - first);
+        if (count == 0) {
+            return;
+        }
+        prepareAppend(m_size + count);
+        std::copy_n(first, count, m_storage->data + m_size);
+        m_size += count;
+        m_storage->used = m_size;
+    }
+    void resize(std::size_t size, T value = T()) {
+        if (size <= m_size) {
+            truncate(size);
+            return;
+        }
+        prepareAppend(size);
+        std::fill(m_storage->data + m_size, m_storage->data + size, value);
+        m_size = size;
+        m_storage->used = m_size;
+    }
+    void assign(std::size_t size, T value) {
+        clear();
+        resize(size, value);
+    }
+    void set(std::size_t index, T value) {
+        if (index < m_storage->frozen.load(std::memory_order_relaxed)) {
+            reallocate(capacity());
+        }
+        m_storage->data[index] = value;
+    }
+    void pop_back() { truncate(m_size - 1); }
+    void clear() {
+        m_storage.reset();
+        m_size = 0;
+    }
+
+   private:
+    struct Storage {
+        std::unique_ptr<T[]> buffer;  // owns data unless it is a view
+        T* data = nullptr;
+        std::shared_ptr<const void> owner;  // keeps the data of a view
+        std::size_t capacity = 0;
+        std::size_t used = 0;  // size of the vector that appends in place
+        std::atomic<std::size_t> frozen{0};  // largest size of a snapshot
+    };
+
+    void freeze() {
+        if (m_storage == nullptr) {
+            return;
+        }
+        auto frozen = m_storage->frozen.load(std::memory_order_relaxed);
+        while (frozen < m_size &&
+               !m_storage->frozen.compare_exchange_weak(
+                   frozen, m_size, std::memory_order_relaxed)) {
+        }
+    }
+    // appending in place is only allowed at the end of the shared storage
+    void prepareAppend(std::size_t size) {
+        if (size > capacity()) {
+            reallocate(std::max<std::size_t>({size, capacity() * 2, 16}));
+        } else if (m_size != m_storage->used) {
+            reallocate(capacity());
+        }
+    }
+    void truncate(std::size_t size) {
+        if (size >= m_size) {
+            return;
+        }
+        if (size < m_storage->frozen.load(std::memory_order_relaxed)) {
+            reallocate(capacity());
+        }
+        m_size = size;
+        m_storage->used = m_size;
+    }
+    void reallocate(std::size_t capacity) {
+        auto storage = std::make_shared<Storage>();
+        storage->buffer.reset(new T[capacity]);
+        storage->data = storage->buffer.get();
+        storage->capacity = capacity;
+        storage->used = m_size;
+        if (m_size != 0) {
+            std::copy_n(m_storage->data, m_size, storage->data);
+        }
+        m_storage = std::move(storage);
+    }
+
+    std::shared_ptr<Storage> m_storage;
+    std::size_t m_size;
+};
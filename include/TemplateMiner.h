@@ -0,0 +1,83 @@
+#pragma once
+#include <ClassDictionary.h>
+#include <IndexStream.h>
+#include <LogTable.h>
+#include <LogText.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// online message template miner after Drain: the header message of every
+// record is split at spaces into interned tokens, tokens containing a digit
+// become the wildcard "<*>" right away. A fixed depth tree routes a message
+// by class and token count and then by its first tokens to a leaf of
+// candidate templates, the most similar one absorbs the message by turning
+// the tokens that differ into wildcards. Templates never mix classes
+class TemplateMiner {
+   public:
+    struct Template {
+        std::uint32_t classId;
+        std::vector<std::uint32_t> tokens;  // interned, text() spells them out
+        std::uint64_t count;
+        std::int64_t first;  // time of the first and last record
+        std::int64_t last;
+    };
+
+    TemplateMiner();
+
+    void clear();
+    // assigns templates to the records of table that have none yet and
+    // appends their ids to table.templateIds, up to the first record whose
+    // message does not end within text
+    void index(const LogText& text, LogTable& table);
+    // takes the records of table from firstRecord on back out of their
+    // templates, before the table drops them. A template they created is
+    // removed, one they widened stays as wide
+    void forget(const LogTable& table, std::size_t firstRecord);
+
+    std::uint32_t size() const {
+        return static_cast<std::uint32_t>(m_templates.size());
+    }
+    const Template& at(std::uint32_t id) const { return m_templates[id]; }
+    // tokens of a template joined by spaces
+    std::string text(std::uint32_t id) const;
+
+    // the tree is saved as well so mining goes on after loading, load fails
+    // the reader on ids out of range or a tree mining could not walk
+    void save(IndexWriter& writer) const;
+    void load(IndexReader& reader);
+
+   private:
+    // tokens routing a message below its class and token count
+    static constexpr std::size_t PrefixDepth = 2;
+    // a node with this many children sends new tokens to its wildcard child
+    static constexpr std::size_t MaxChildren = 100;
+    // share of equal tokens for a message to join a template
+    static constexpr double SimilarityThreshold = 0.4;
+
+    struct Node {
+        std::uint32_t childCount = 0;
+        std::vector<std::uint32_t> templates;  // of a leaf
+    };
+
+    std::uint32_t assign(std::uint32_t classId, std::int64_t timestamp,
+                         const char* begin, const char* end);
+    void tokenize(const char* begin, const char* end);
+    std::uint32_t child(std::uint32_t node, std::uint32_t token);
+    std::uint32_t newNode();
+    // ids of the loaded tree are in range and the templates of a leaf have
+    // the token count of its group
+    bool isConsistent() const;
+
+    std::uint32_t m_wildcard;  // token id of <*>
+    ClassDictionary m_tokenDictionary;
+    std::vector<Template> m_templates;
+    std::vector<Node> m_nodes;
+    // child of a node by node << 32 | token, groups of the root by
+    // class << 32 | token count
+    std::unordered_map<std::uint64_t, std::uint32_t> m_children;
+    std::unordered_map<std::uint64_t, std::uint32_t> m_groups;
+    std::vector<std::uint32_t> m_tokens;  // of the message being mined
+};
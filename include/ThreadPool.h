@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads with one task queue each. Workers take tasks
+// from the back of their own queue and steal from the front of the others
+// when it runs dry, so uneven tasks still keep every core busy
+class ThreadPool {
+   public:
+    // threadCount includes the thread calling parallelFor
+    ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t threadCount() const { return m_threads.size() + 1; }
+
+    // runs task(0) .. task(count - 1) and returns once all of them finished,
+    // the calling thread works on them too
+    void parallelFor(std::size_t count,
+                     const std::function<void(std::size_t)>& task);
+
+   private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // runs one task of queue index or one stolen from another queue
+    bool runOne(std::size_t index);
+    void workerLoop(std::size_t index);
+
+    // one queue per worker, the last one belongs to callers of parallelFor
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::atomic<std::size_t> m_queued;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    bool m_stopping;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <LogTable.h>
+#include <SnapshotVector.h>
+
+#include <cstdint>
+
+// sparse index over the timestamp column, the minimum and maximum time of
+// every block of 1024 rows. Logs are written in time order up to a few out
+// of order records, so the running maximum of the blocks is a sorted array
+// that finds the first row at a time by binary search, and whole blocks
+// inside or outside a time range are decided without reading their rows.
+// The lines before the first record header have no time of their own: they
+// are left out of the blocks and fall in every range, as they pass every
+// level filter. Copies are snapshots that share the columns
+class TimeIndex {
+   public:
+    static constexpr std::size_t RowsPerBlock = 1024;
+
+    void clear();
+    // indexes the rows of a table that extends the previously indexed one,
+    // or that was truncated since
+    void index(const LogTable& table);
+
+    std::size_t rowCount() const { return m_timestamps.size(); }
+    // rows before the first record header
+    std::size_t preambleRows() const { return m_preambleRows; }
+    std::int64_t timestamp(std::size_t row) const { return m_timestamps[row]; }
+    // earliest and latest time of the indexed records, 0 without records
+    std::int64_t minimum() const;
+    std::int64_t maximum() const;
+
+    // first row whose time is at or after time, rowCount() if there is none
+    std::size_t lowerBound(std::int64_t time) const;
+    bool isInRange(std::size_t row, std::int64_t from, std::int64_t to) const {
+        return row < m_preambleRows ||
+               (m_timestamps[row] >= from && m_timestamps[row] <= to);
+    }
+    // bit i is set when row word * 64 + i is in [from, to]
+    std::uint64_t rangeBits(std::size_t word, std::int64_t from,
+                            std::int64_t to) const;
+
+   private:
+    std::size_t m_preambleRows = 0;
+    SnapshotVector<std::int64_t> m_timestamps;
+    SnapshotVector<std::int64_t> m_minimums;
+    SnapshotVector<std::int64_t> m_maximums;
+    SnapshotVector<std::int64_t> m_latest;  // maximum up to every block
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <LogDocument.h>
+#include <LogHistogram.h>
+
+#include <QColor>
+#include <QWidget>
+#include <memory>
+
+// vertical minimap of the log over time, one bar per time bucket showing
+// how many records of every level were written in it. Time runs down, the
+// wheel zooms around the cursor and a double click shows the whole log
+// again. Buckets come from the histogram level matching the zoom, so
+// zooming never goes back to the rows
+class TimelineWidget : public QWidget {
+    Q_OBJECT
+   public:
+    TimelineWidget(QWidget* parent = nullptr);
+
+    QSize sizeHint() const override;
+
+    void clear();
+    // a document of the shown generation only counts its new rows
+    void setLogDocument(std::shared_ptr<const LogDocument> document);
+
+   signals:
+    // time at the clicked position, microseconds since epoch
+    void timeClicked(qint64 time);
+
+   protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+
+   private:
+    // smallest zoomed span in base buckets
+    static constexpr std::int64_t MinBuckets = 16;
+
+    bool isZoomed() const { return m_viewEnd > m_viewBegin; }
+    std::int64_t viewBegin() const;
+    std::int64_t viewEnd() const;
+    std::int64_t timeAt(int y) const;
+
+    std::shared_ptr<const LogDocument> m_document;
+    LogHistogram m_histogram;
+    // zoomed time span, empty while the whole log is shown
+    std::int64_t m_viewBegin;
+    std::int64_t m_viewEnd;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <IndexStream.h>
+#include <LineIndex.h>
+#include <LogText.h>
+#include <ThreadPool.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// inverted index from the trigrams of the log text to the blocks of 64
+// lines containing them, a block is one word of a VisibleLines bitmap.
+// ASCII letters are folded to lower case so the same index serves case
+// sensitive and insensitive queries. Indexing blocks instead of lines keeps
+// the index at a few percent of the text while a query only verifies the
+// blocks that contain all of its trigrams
+class TrigramIndex {
+   public:
+    static constexpr std::size_t LinesPerBlock = 64;
+
+    TrigramIndex();
+
+    void clear();
+    // forgets the lines from lineCount on. Their trigrams may stay in the
+    // posting list of the last block, which only costs a block that is
+    // verified for nothing
+    void truncate(std::size_t lineCount);
+    std::size_t lineCount() const { return m_lineCount; }
+    // the posting lists are copied, they keep growing while loading. load
+    // fails the reader on blocks that are not ascending below lineCount()
+    void save(IndexWriter& writer) const;
+    void load(IndexReader& reader);
+
+    // indexes the lines of lineIndex that are not indexed yet and end
+    // within text, which starts at or before the first of them. Ranges of
+    // whole blocks are indexed in parallel
+    void index(const LogText& text, const LineIndex& lineIndex,
+               ThreadPool& pool);
+
+    // ascending blocks below lineCount() that may contain literal, every
+    // block when literal is shorter than a trigram
+    std::vector<std::uint32_t> candidateBlocks(std::string_view literal) const;
+
+   private:
+    // lines per task when indexing in parallel
+    static constexpr std::size_t MinLinesPerTask = 16 * 1024;
+
+    static std::uint32_t hash(std::uint32_t trigram);
+    void addLines(const LogText& text, const LineIndex& lineIndex,
+                  std::size_t firstLine, std::size_t lastLine);
+    void append(const TrigramIndex& next);
+    std::vector<std::uint32_t>& postings(std::uint32_t trigram);
+    const std::vector<std::uint32_t>* findPostings(
+        std::uint32_t trigram) const;
+    std::size_t slotOf(std::uint32_t trigram) const;
+    void rehash(std::size_t slotCount);
+
+    std::size_t m_lineCount;
+    std::vector<std::uint32_t> m_trigrams;  // trigram of every posting list
+    std::vector<std::vector<std::uint32_t>> m_postings;  // ascending blocks
+    std::vector<std::uint32_t> m_slots;  // open addressing, index + 1 or 0
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// set of visible line indices stored as a bitmap with a rank directory, so
+// a single line can be shown or hidden in O(1) and the n-th visible line is
+// found with a binary search over blocks of 512 lines
+class VisibleLines {
+   public:
+    VisibleLines();
+
+    void reset(std::size_t lineCount, bool visible);
+    // keeps the lines below lineCount, new lines are hidden
+    void resize(std::size_t lineCount);
+    std::size_t lineCount() const { return m_lineCount; }
+    std::size_t size() const { return m_count; }
+
+    bool contains(std::uint32_t line) const {
+        return (m_words[line >> 6] >> (line & 63)) & 1;
+    }
+    void set(std::uint32_t line, bool visible);
+    // overwrites 64 lines starting at word * 64, bits past lineCount are
+    // ignored
+    void setWord(std::size_t word, std::uint64_t bits);
+    // must be called after modifications, before lineAt or rowOf are used
+    void updateRanks();
+
+    std::uint32_t lineAt(std::size_t row) const;
+    std::size_t rowOf(std::uint32_t line) const;  // visible lines before line
+    // the lines below other.lineCount() are visible exactly as in other, so
+    // the rows of other are the first rows of this
+    bool extends(const VisibleLines& other) const;
+
+   private:
+    static constexpr std::size_t WordsPerBlock = 8;
+
+    std::size_t m_lineCount;
+    std::size_t m_count;
+    std::vector<std::uint64_t> m_words;
+    std::vector<std::size_t> m_blockRanks;  // visible lines before a block
+};
@@ -3,14 +3,31 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <cstring>
 
 int main(int argc, char *argv[]) {
-    Logger::init_logger();
+    // --sync-log writes and flushes every message immediately, useful when
+    // the application crashes before the async queue is drained
+    Logger::LoggerOptions loggerOptions;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--sync-log") == 0) {
+            loggerOptions.async = false;
+        }
+    }
+    Logger::init_logger(loggerOptions);
 
-    QApplication app(argc, argv);
-    QCoreApplication::setApplicationName("LogReader");
-    MainWindow mainWindow;
-    mainWindow.show();
-    Logger::info("Application started");
-    return app.exec();
+    int result = 0;
+    {
+        // the window, its processor thread and the application still log
+        // while they are destroyed, so they go before the logger
+        QApplication app(argc, argv);
+        QCoreApplication::setApplicationName("LogReader");
+        MainWindow mainWindow;
+        mainWindow.show();
+        Logger::info("Application started");
+        result = app.exec();
+        Logger::info("Application exited");
+    }
+    Logger::shutdown();  // drain the async queue before the sinks go away
+    return result;
 }
\ No newline at end of file
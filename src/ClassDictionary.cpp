@@ -0,0 +1,69 @@
+#include <ClassDictionary.h>
+
+std::uint32_t ClassDictionary::intern(std::string_view name) {
+    if (m_slots.empty()) {
+        rehash(64);
+    }
+    auto nameHash = hash(name);
+    auto slot = slotOf(name, nameHash);
+    if (m_slots[slot] != 0) {
+        return m_slots[slot] - 1;
+    }
+    auto id = static_cast<std::uint32_t>(m_names.size());
+    m_names.emplace_back(name);
+    m_hashes.push_back(nameHash);
+    m_slots[slot] = id + 1;
+    if (m_names.size() * 2 > m_slots.size()) {  // keep load factor below 0.5
+        rehash(m_slots.size() * 2);
+    }
+    return id;
+}
+
+std::uint32_t ClassDictionary::find(std::string_view name) const {
+    if (m_slots.empty()) {
+        return NoId;
+    }
+    auto slot = slotOf(name, hash(name));
+    return m_slots[slot] == 0 ? NoId : m_slots[slot] - 1;
+}
+
+void ClassDictionary::clear() {
+    m_names.clear();
+    m_hashes.clear();
+    m_slots.clear();
+}
+
+std::uint64_t ClassDictionary::hash(std::string_view name) {
+    std::uint64_t value = 14695981039346656037ull;  // FNV-1a
+    for (auto c : name) {
+        value ^= static_cast<unsigned char>(c);
+        value *= 1099511628211ull;
+    }
+    return value;
+}
+
+std::size_t ClassDictionary::slotOf(std::string_view name,
+                                    std::uint64_t nameHash) const {
+    auto mask = m_slots.size() - 1;
+    auto slot = static_cast<std::size_t>(nameHash) & mask;
+    while (m_slots[slot] != 0) {
+        auto id = m_slots[slot] - 1;
+        if (m_hashes[id] == nameHash && m_names[id] == name) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void ClassDictionary::rehash(std::size_t slotCount) {
+    m_slots.assign(slotCount, 0);
+    auto mask = slotCount - 1;
+    for (std::uint32_t id = 0; id < m_names.size(); id++) {
+        auto slot = static_cast<std::size_t>(m_hashes[id]) & mask;
+        while (m_slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = id + 1;
+    }
+}
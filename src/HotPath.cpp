@@ -0,0 +1,88 @@
+#include <HotPath.h>
+
+#if defined(LOGREADER_HOT_PATH_STATS)
+#include <Logger.h>
+
+namespace HotPath {
+namespace {
+std::atomic<Counter *> counterList{nullptr};
+std::atomic<Sample *> sampleList{nullptr};
+std::atomic<Timer *> timerList{nullptr};
+
+template <typename Entry>
+void push(std::atomic<Entry *> &head, Entry *entry) {
+    entry->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(entry->next, entry,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+void updateMax(std::atomic<std::uint64_t> &max, std::uint64_t value) {
+    auto current = max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max.compare_exchange_weak(current, value,
+                                      std::memory_order_relaxed)) {
+    }
+}
+}  // namespace
+
+Counter::Counter(const char *name) : name(name), value(0), next(nullptr) {
+    push(counterList, this);
+}
+
+Sample::Sample(const char *name)
+    : name(name), calls(0), samples(0), sum(0), max(0), next(nullptr) {
+    push(sampleList, this);
+}
+
+void Sample::record(std::uint64_t value) {
+    if (calls.fetch_add(1, std::memory_order_relaxed) % Every != 0) {
+        return;
+    }
+    samples.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    updateMax(max, value);
+}
+
+Timer::Timer(const char *name)
+    : name(name),
+      calls(0),
+      totalNanoseconds(0),
+      maxNanoseconds(0),
+      next(nullptr) {
+    push(timerList, this);
+}
+
+void Timer::record(std::uint64_t nanoseconds) {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    updateMax(maxNanoseconds, nanoseconds);
+}
+
+void report() {
+    for (auto timer = timerList.load(std::memory_order_acquire); timer;
+         timer = timer->next) {
+        Logger::debug("Hot path {}: {} calls, total {:.3f} ms, max {:.3f} ms",
+                      timer->name, timer->calls.load(),
+                      timer->totalNanoseconds.load() / 1e6,
+                      timer->maxNanoseconds.load() / 1e6);
+    }
+    for (auto sample = sampleList.load(std::memory_order_acquire); sample;
+         sample = sample->next) {
+        auto sampled = sample->samples.load();
+        Logger::debug("Hot path {}: {} calls, sampled mean {:.1f}, max {}",
+                      sample->name, sample->calls.load(),
+                      sampled == 0 ? 0.0
+                                   : static_cast<double>(sample->sum.load()) /
+                                         sampled,
+                      sample->max.load());
+    }
+    for (auto counter = counterList.load(std::memory_order_acquire); counter;
+         counter = counter->next) {
+        Logger::debug("Hot path {}: {}", counter->name,
+                      counter->value.load());
+    }
+}
+}  // namespace HotPath
+#endif
@@ -0,0 +1,187 @@
+#include <HotPath.h>
+#include <IndexFile.h>
+#include <Logger.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <array>
+#include <memory>
+
+namespace {
+using Magic = std::array<char, 8>;
+constexpr Magic IndexMagic = {'L', 'R', 'I', 'D', 'X', '\r', '\n', '\0'};
+constexpr std::uint64_t HashBasis = 0xcbf29ce484222325ull;
+constexpr std::uint64_t HashPrime = 0x100000001b3ull;
+
+// the mapped sidecar, whose columns the loaded indexes use in place. A
+// sidecar is only ever replaced by renaming a new file over it, so unlike
+// a followed log the mapping cannot shrink under them
+struct MappedSidecar {
+    explicit MappedSidecar(const QString &fileName) : file(fileName) {}
+    ~MappedSidecar() {
+        if (data != nullptr) {
+            file.unmap(data);
+        }
+    }
+
+    QFile file;
+    uchar *data = nullptr;
+};
+
+// template ids of the records and class ids of the templates, which the
+// parts cannot check on their own
+bool idsInRange(const LogTable &table, const TemplateMiner &miner) {
+    for (auto id : table.templateIds) {
+        if (id >= miner.size() && id != LogTable::NoTemplate) {
+            return false;
+        }
+    }
+    for (std::uint32_t id = 0; id < miner.size(); id++) {
+        auto classId = miner.at(id).classId;
+        if (classId >= table.classes.size() && classId != LogTable::NoClass) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+IndexFile::IndexFile(const QString &logFileName)
+    : m_fileName(logFileName + ".lridx") {}
+
+std::uint64_t IndexFile::load(const LogFile &logFile, LineIndex &lineIndex,
+                              LogTable &table, LevelCounts &levelCounts,
+                              TrigramIndex *trigramIndex,
+                              TemplateMiner &miner) {
+    if (!QFileInfo::exists(m_fileName)) {
+        return 0;
+    }
+    HOT_PATH_SCOPE("IndexFile::load");
+    auto sidecar = std::make_shared<MappedSidecar>(m_fileName);
+    if (!sidecar->file.open(QIODevice::ReadOnly)) {
+        Logger::warn("Failed to open index file: {}", m_fileName.toStdString());
+        return 0;
+    }
+    const auto sidecarSize = sidecar->file.size();
+    if (sidecarSize > 0) {
+        sidecar->data = sidecar->file.map(0, sidecarSize);
+    }
+    IndexReader reader(reinterpret_cast<const char *>(sidecar->data),
+                       static_cast<std::size_t>(sidecarSize), sidecar);
+    auto magic = reader.read<Magic>();
+    auto version = reader.read<std::uint32_t>();
+    if (magic != IndexMagic || version != Version) {
+        Logger::info("Index file of another version: {}",
+                     m_fileName.toStdString());
+        return 0;
+    }
+
+    // a log that grew keeps its indexed part, anything else is parsed again
+    const auto logSize = static_cast<std::uint64_t>(logFile.size());
+    auto savedLogSize = reader.read<std::uint64_t>();
+    auto savedTime = reader.read<qint64>();
+    auto indexedSize = reader.read<std::uint64_t>();
+    auto headHash = reader.read<std::uint64_t>();
+    auto tailHash = reader.read<std::uint64_t>();
+    const auto hashed = std::min(HashBytes, indexedSize);
+    if (!reader.ok() || indexedSize > logSize || logSize < savedLogSize ||
+        (logSize == savedLogSize &&
+         savedTime != modificationTime(logFile)) ||
+        headHash != hash(logFile.text(0, hashed)) ||
+        tailHash != hash(logFile.text(indexedSize - hashed, indexedSize))) {
+        Logger::info("Index file outdated: {}", m_fileName.toStdString());
+        return 0;
+    }
+
+    lineIndex.load(reader);
+    auto counts = reader.readVector<std::uint64_t>();
+    table.load(reader, indexedSize);
+    auto hasTrigramIndex = reader.read<std::uint8_t>() != 0;
+    if (trigramIndex != nullptr && hasTrigramIndex) {
+        trigramIndex->load(reader);
+    } else if (hasTrigramIndex) {
+        TrigramIndex().load(reader);  // skipped
+    }
+    miner.load(reader);
+    if (!reader.ok() || reader.read<Magic>() != IndexMagic ||
+        lineIndex.indexedSize() != indexedSize ||
+        lineIndex.lineCount() != table.size() ||
+        counts.size() != levelCounts.size() ||
+        (trigramIndex != nullptr &&
+         trigramIndex->lineCount() > lineIndex.lineCount()) ||
+        !idsInRange(table, miner)) {
+        Logger::warn("Index file damaged: {}", m_fileName.toStdString());
+        lineIndex.clear();
+        table.clear();
+        if (trigramIndex != nullptr) {
+            trigramIndex->clear();
+        }
+        miner.clear();
+        return 0;
+    }
+    std::copy(counts.begin(), counts.end(), levelCounts.begin());
+    Logger::info("Index file loaded: {} lines, {} bytes of the log",
+                 lineIndex.lineCount(), indexedSize);
+    return indexedSize;
+}
+
+bool IndexFile::save(const LogFile &logFile, const LineIndex &lineIndex,
+                     const LogTable &table, const LevelCounts &levelCounts,
+                     const TrigramIndex *trigramIndex,
+                     const TemplateMiner &miner) const {
+    HOT_PATH_SCOPE("IndexFile::save");
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        Logger::warn("Failed to write index file: {}",
+                     m_fileName.toStdString());
+        return false;
+    }
+    IndexWriter writer([&file](const char *data, std::size_t size) {
+        return file.write(data, static_cast<qint64>(size)) ==
+               static_cast<qint64>(size);
+    });
+    const auto indexedSize = lineIndex.indexedSize();
+    const auto hashed = std::min(HashBytes, indexedSize);
+    writer.write(IndexMagic);
+    writer.write(Version);
+    writer.write<std::uint64_t>(logFile.size());
+    writer.write(modificationTime(logFile));
+    writer.write(indexedSize);
+    writer.write(hash(logFile.text(0, hashed)));
+    writer.write(hash(logFile.text(indexedSize - hashed, indexedSize)));
+
+    lineIndex.save(writer);
+    writer.writeArray(levelCounts.data(), levelCounts.size());
+    table.save(writer);
+    writer.write<std::uint8_t>(trigramIndex != nullptr);
+    if (trigramIndex != nullptr) {
+        trigramIndex->save(writer);
+    }
+    miner.save(writer);
+    writer.write(IndexMagic);  // tells a complete file
+
+    if (!writer.ok() || !file.commit()) {
+        file.cancelWriting();
+        Logger::warn("Failed to write index file: {}",
+                     m_fileName.toStdString());
+        return false;
+    }
+    Logger::info("Index file saved: {} bytes", writer.size());
+    return true;
+}
+
+std::uint64_t IndexFile::hash(const LogText &text) {
+    auto value = HashBasis;
+    for (std::uint64_t i = 0; i < text.size(); i++) {
+        value =
+            (value ^ static_cast<unsigned char>(text.data()[i])) * HashPrime;
+    }
+    return value;
+}
+
+qint64 IndexFile::modificationTime(const LogFile &logFile) {
+    return QFileInfo(logFile.fileName()).lastModified().toMSecsSinceEpoch();
+}
@@ -0,0 +1,164 @@
+#include <HotPath.h>
+#include <LineIndex.h>
+#include <Simd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace {
+void scanNewlinesScalar(const LogText &text, std::uint64_t begin,
+                        std::uint64_t end,
+                        SnapshotVector<std::uint64_t> &offsets) {
+    auto current = text.at(begin);
+    auto last = text.at(end);
+    while (current < last) {
+        auto newline = static_cast<const char *>(
+            std::memchr(current, '\n', last - current));
+        if (newline == nullptr) {
+            break;
+        }
+        offsets.push_back(text.offsetOf(newline) + 1);
+        current = newline + 1;
+    }
+}
+
+#if defined(LOGREADER_SIMD_X86)
+// returns the first offset that was not scanned
+std::uint64_t scanNewlinesSse2(const LogText &text, std::uint64_t begin,
+                               std::uint64_t end,
+                               SnapshotVector<std::uint64_t> &offsets) {
+    const auto newline = _mm_set1_epi8('\n');
+    auto position = begin;
+    for (; position + 16 <= end; position += 16) {
+        auto block = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(text.at(position)));
+        auto mask = static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+        while (mask != 0) {
+            offsets.push_back(position + Simd::countTrailingZeros(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+    return position;
+}
+
+LOGREADER_TARGET_AVX2
+std::uint64_t scanNewlinesAvx2(const LogText &text, std::uint64_t begin,
+                               std::uint64_t end,
+                               SnapshotVector<std::uint64_t> &offsets) {
+    const auto newline = _mm256_set1_epi8('\n');
+    auto position = begin;
+    for (; position + 32 <= end; position += 32) {
+        auto block = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(text.at(position)));
+        auto mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+        while (mask != 0) {
+            offsets.push_back(position + Simd::countTrailingZeros(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+    return position;
+}
+#endif
+}  // namespace
+
+LineIndex::LineIndex() : m_endsWithPartialLine(false) {}
+
+void LineIndex::build(const char *data, std::uint64_t size) {
+    clear();
+    m_offsets.reserve(size / 64 + 2);  // rough guess of the average line
+    append(LogText(data, 0, size), true);
+}
+
+void LineIndex::append(const LogText &text, bool atEnd) {
+    HOT_PATH_SCOPE("LineIndex::append");
+    if (m_endsWithPartialLine) {  // the line continues in the new data
+        m_offsets.pop_back();
+        m_endsWithPartialLine = false;
+    }
+    if (m_offsets.empty()) {
+        m_offsets.push_back(0);
+    }
+    const auto begin = m_offsets.back();
+    const auto end = text.end();
+    if (end <= begin) {
+        return;
+    }
+    scanNewlines(text, begin, end, m_offsets);
+    if (atEnd && m_offsets.back() != end) {  // last line without line ending
+        m_offsets.push_back(end);
+        m_endsWithPartialLine = true;
+    }
+}
+
+void LineIndex::reset(std::uint64_t begin) {
+    m_offsets.assign(1, begin);
+    m_endsWithPartialLine = false;
+}
+
+void LineIndex::extend(const LineIndex &next) {
+    if (next.m_offsets.empty()) {
+        return;
+    }
+    if (m_endsWithPartialLine) {
+        m_offsets.pop_back();
+    }
+    if (m_offsets.empty()) {
+        m_offsets.push_back(next.m_offsets.front());
+    }
+    m_offsets.append(next.m_offsets.begin() + 1, next.m_offsets.end());
+    m_endsWithPartialLine = next.m_endsWithPartialLine;
+}
+
+void LineIndex::truncate(std::uint64_t lineCount) {
+    if (lineCount >= this->lineCount()) {
+        return;
+    }
+    m_offsets.resize(lineCount + 1);
+    m_endsWithPartialLine = false;
+}
+
+void LineIndex::clear() {
+    m_offsets.clear();
+    m_endsWithPartialLine = false;
+}
+
+std::uint64_t LineIndex::linesBefore(std::uint64_t offset) const {
+    if (m_offsets.empty()) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(
+        std::upper_bound(m_offsets.begin() + 1, m_offsets.end(), offset) -
+        (m_offsets.begin() + 1));
+}
+
+void LineIndex::scanNewlines(const LogText &text, std::uint64_t begin,
+                             std::uint64_t end,
+                             SnapshotVector<std::uint64_t> &offsets) {
+#if defined(LOGREADER_SIMD_X86)
+    if (Simd::hasAvx2()) {
+        begin = scanNewlinesAvx2(text, begin, end, offsets);
+    }
+    begin = scanNewlinesSse2(text, begin, end, offsets);
+#endif
+    scanNewlinesScalar(text, begin, end, offsets);
+}
+
+void LineIndex::save(IndexWriter &writer) const {
+    writer.writeArray(m_offsets.data(), m_offsets.size());
+    writer.write<std::uint8_t>(m_endsWithPartialLine);
+}
+
+void LineIndex::load(IndexReader &reader) {
+    m_offsets = reader.readView<std::uint64_t>();
+    m_endsWithPartialLine = reader.read<std::uint8_t>() != 0;
+    // every line has at least its last byte
+    if ((!m_offsets.empty() && m_offsets.front() != 0) ||
+        std::adjacent_find(m_offsets.begin(), m_offsets.end(),
+                           std::greater_equal<std::uint64_t>()) !=
+            m_offsets.end()) {
+        reader.fail();
+    }
+}
@@ -0,0 +1,154 @@
+#include <LiteralFinder.h>
+#include <Simd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+char fold(char c) { return c >= 'A' && c <= 'Z' ? c | 0x20 : c; }
+
+// a byte b matches the pattern byte when (b | mask) == value, the mask is
+// 0x20 for letters that match in either case
+struct BytePattern {
+    char value;
+    char mask;
+};
+
+BytePattern bytePattern(char c, bool matchCase) {
+    auto lower = static_cast<char>(c | 0x20);
+    if (!matchCase && lower >= 'a' && lower <= 'z') {
+        return {lower, 0x20};
+    }
+    return {c, 0};
+}
+
+// the kernels scan the start positions [position, limit), they return true
+// with position at the first verified match or false with position at the
+// first start they did not scan
+template <typename Verify>
+bool findScalar(const char *data, std::uint64_t &position,
+                std::uint64_t limit, std::size_t size, BytePattern first,
+                BytePattern last, Verify verify) {
+    for (; position < limit; position++) {
+        if ((data[position] | first.mask) == first.value &&
+            (data[position + size - 1] | last.mask) == last.value &&
+            verify(position)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(LOGREADER_SIMD_X86)
+template <typename Verify>
+bool findSse2(const char *data, std::uint64_t &position, std::uint64_t limit,
+              std::size_t size, BytePattern first, BytePattern last,
+              Verify verify) {
+    const auto firstValue = _mm_set1_epi8(first.value);
+    const auto firstMask = _mm_set1_epi8(first.mask);
+    const auto lastValue = _mm_set1_epi8(last.value);
+    const auto lastMask = _mm_set1_epi8(last.mask);
+    for (; position + 16 <= limit; position += 16) {
+        auto firstBytes = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(data + position));
+        auto lastBytes = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(data + position + size - 1));
+        auto candidates = _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_or_si128(firstBytes, firstMask), firstValue),
+            _mm_cmpeq_epi8(_mm_or_si128(lastBytes, lastMask), lastValue));
+        auto mask =
+            static_cast<std::uint32_t>(_mm_movemask_epi8(candidates));
+        for (; mask != 0; mask &= mask - 1) {
+            auto candidate = position + Simd::countTrailingZeros(mask);
+            if (verify(candidate)) {
+                position = candidate;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename Verify>
+LOGREADER_TARGET_AVX2 bool findAvx2(const char *data, std::uint64_t &position,
+                                    std::uint64_t limit, std::size_t size,
+                                    BytePattern first, BytePattern last,
+                                    Verify verify) {
+    const auto firstValue = _mm256_set1_epi8(first.value);
+    const auto firstMask = _mm256_set1_epi8(first.mask);
+    const auto lastValue = _mm256_set1_epi8(last.value);
+    const auto lastMask = _mm256_set1_epi8(last.mask);
+    for (; position + 32 <= limit; position += 32) {
+        auto firstBytes = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(data + position));
+        auto lastBytes = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(data + position + size - 1));
+        auto candidates = _mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_or_si256(firstBytes, firstMask),
+                              firstValue),
+            _mm256_cmpeq_epi8(_mm256_or_si256(lastBytes, lastMask),
+                              lastValue));
+        auto mask =
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(candidates));
+        for (; mask != 0; mask &= mask - 1) {
+            auto candidate = position + Simd::countTrailingZeros(mask);
+            if (verify(candidate)) {
+                position = candidate;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+#endif
+}  // namespace
+
+LiteralFinder::LiteralFinder(std::string literal, bool matchCase)
+    : m_literal(std::move(literal)), m_matchCase(matchCase) {
+    if (!m_matchCase) {
+        std::transform(m_literal.begin(), m_literal.end(), m_literal.begin(),
+                       fold);
+    }
+}
+
+std::uint64_t LiteralFinder::find(const char *data, std::uint64_t begin,
+                                  std::uint64_t end) const {
+    const auto size = m_literal.size();
+    if (size == 0 || end - begin < size) {
+        return size == 0 ? begin : end;
+    }
+    const auto limit = end - size + 1;  // last start position + 1
+    const auto first = bytePattern(m_literal.front(), m_matchCase);
+    const auto last = bytePattern(m_literal.back(), m_matchCase);
+    auto verify = [&](std::uint64_t position) {
+        return matchesAt(data + position);
+    };
+    auto position = begin;
+#if defined(LOGREADER_SIMD_X86)
+    if (Simd::hasAvx2() &&
+        findAvx2(data, position, limit, size, first, last, verify)) {
+        return position;
+    }
+    if (findSse2(data, position, limit, size, first, last, verify)) {
+        return position;
+    }
+#endif
+    if (findScalar(data, position, limit, size, first, last, verify)) {
+        return position;
+    }
+    return end;
+}
+
+bool LiteralFinder::matchesAt(const char *text) const {
+    const auto size = m_literal.size();
+    if (m_matchCase) {
+        return std::memcmp(text, m_literal.data(), size) == 0;
+    }
+    for (std::size_t i = 0; i < size; i++) {
+        if (fold(text[i]) != m_literal[i]) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,570 @@
+#include <HotPath.h>
+#include <LogDecompressor.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#if defined(LOGREADER_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(LOGREADER_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace {
+// zlib counts its buffers in 32 bits
+constexpr std::uint64_t MaxStepBytes = 1u << 30;
+// compressed bytes read at once
+constexpr std::uint64_t InputBytes = 1024 * 1024;
+// deflate refers back at most this far
+constexpr std::size_t WindowBytes = 32 * 1024;
+
+std::uint32_t readLittleEndian32(const char *data) {
+    std::uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = value << 8 | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+bool isGzipMember(const LogText &text) {
+    return text.size() >= 2 &&
+           static_cast<unsigned char>(text.data()[0]) == 0x1f &&
+           static_cast<unsigned char>(text.data()[1]) == 0x8b;
+}
+
+// a zstd frame or a skippable frame, like the index of a seekable file
+bool isZstdFrame(const LogText &text) {
+    if (text.size() < 4) {
+        return false;
+    }
+    const auto magic = readLittleEndian32(text.data());
+    return magic == 0xfd2fb528u || (magic & 0xfffffff0u) == 0x184d2a50u;
+}
+
+// a page packed fast into a single zstd frame, empty without zstd
+std::string packPage(std::string_view text) {
+#if defined(LOGREADER_ZSTD)
+    std::string packed(ZSTD_compressBound(text.size()), '\0');
+    const auto size = ZSTD_compress(packed.data(), packed.size(), text.data(),
+                                    text.size(), 1);
+    if (!ZSTD_isError(size)) {
+        packed.resize(size);
+        return packed;
+    }
+#else
+    (void)text;
+#endif
+    return std::string();
+}
+
+bool unpackPage(const std::string &packed, char *data, std::uint64_t size) {
+#if defined(LOGREADER_ZSTD)
+    return ZSTD_decompress(data, size, packed.data(), packed.size()) == size;
+#else
+    (void)packed;
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+}  // namespace
+
+// decodes the compressed file from a checkpoint on, reading it a piece at
+// a time. The decoder of loading records the checkpoints it passes
+class LogDecompressor::Decoder {
+   public:
+    Decoder(const LogFile &compressed, Format format, bool recording)
+        : m_compressed(compressed),
+          m_format(format),
+          m_recording(recording),
+          m_position(0),
+          m_output(0),
+          m_lastCheckpoint(0),
+          m_atEnd(false),
+          m_failed(true) {
+#if defined(LOGREADER_ZLIB)
+        if (m_format == Format::Gzip) {
+            // 15 bits of window, + 16 reads the gzip header and trailer
+            m_zlibOpen = inflateInit2(&m_zlib, 15 + 16) == Z_OK;
+        }
+#endif
+#if defined(LOGREADER_ZSTD)
+        if (m_format == Format::Zstd) {
+            m_zstd = ZSTD_createDStream();
+        }
+#endif
+    }
+
+    ~Decoder() {
+#if defined(LOGREADER_ZLIB)
+        if (m_zlibOpen) {
+            inflateEnd(&m_zlib);
+        }
+#endif
+#if defined(LOGREADER_ZSTD)
+        if (m_zstd != nullptr) {
+            ZSTD_freeDStream(m_zstd);
+        }
+#endif
+    }
+
+    Decoder(const Decoder &) = delete;
+    Decoder &operator=(const Decoder &) = delete;
+
+    void start(const Checkpoint &checkpoint);
+    // decodes up to size bytes into data, fewer only at the end of the text
+    // or on failure
+    std::uint64_t read(char *data, std::uint64_t size);
+
+    std::uint64_t position() const { return m_position; }
+    std::uint64_t output() const { return m_output; }
+    bool atEnd() const { return m_atEnd; }
+    bool failed() const { return m_failed; }
+    // the checkpoints passed since the last call
+    std::vector<Checkpoint> takeCheckpoints() { return std::move(m_found); }
+
+   private:
+    // the compressed bytes from m_position on, empty at the end of file
+    const LogText &input();
+    std::uint64_t inflateGzip(char *data, std::uint64_t size);
+    std::uint64_t decompressZstd(char *data, std::uint64_t size);
+
+    const LogFile &m_compressed;
+    Format m_format;
+    bool m_recording;
+    LogText m_input;
+    std::uint64_t m_position;  // of the next compressed byte
+    std::uint64_t m_output;
+    std::uint64_t m_lastCheckpoint;
+    bool m_atEnd;
+    bool m_failed;
+    std::vector<Checkpoint> m_found;
+#if defined(LOGREADER_ZLIB)
+    z_stream m_zlib{};
+    bool m_zlibOpen = false;
+    bool m_raw = false;  // started inside a member, without its header
+#endif
+#if defined(LOGREADER_ZSTD)
+    ZSTD_DStream *m_zstd = nullptr;
+    bool m_frameEnd = true;  // no frame was left unfinished
+#endif
+};
+
+void LogDecompressor::Decoder::start(const Checkpoint &checkpoint) {
+    m_input = LogText();
+    m_position = checkpoint.input;
+    m_output = checkpoint.output;
+    m_lastCheckpoint = checkpoint.output;
+    m_atEnd = false;
+    m_failed = true;
+    m_found.clear();
+#if defined(LOGREADER_ZLIB)
+    if (m_format == Format::Gzip && m_zlibOpen) {
+        if (checkpoint.input == 0) {
+            m_raw = false;
+            m_failed = inflateReset2(&m_zlib, 15 + 16) != Z_OK;
+            return;
+        }
+        // raw deflate inside the member, fed the bits of the byte before
+        // and the window
+        m_raw = true;
+        m_failed = inflateReset2(&m_zlib, -15) != Z_OK;
+        if (!m_failed && checkpoint.bits != 0) {
+            const auto byte =
+                m_compressed.text(checkpoint.input - 1, checkpoint.input);
+            m_failed =
+                byte.size() != 1 ||
+                inflatePrime(&m_zlib, checkpoint.bits,
+                             static_cast<unsigned char>(byte.data()[0]) >>
+                                 (8 - checkpoint.bits)) != Z_OK;
+        }
+        if (!m_failed && !checkpoint.window.empty()) {
+            m_failed = inflateSetDictionary(
+                           &m_zlib, checkpoint.window.data(),
+                           static_cast<uInt>(checkpoint.window.size())) !=
+                       Z_OK;
+        }
+    }
+#endif
+#if defined(LOGREADER_ZSTD)
+    if (m_format == Format::Zstd && m_zstd != nullptr) {
+        m_frameEnd = true;
+        m_failed = ZSTD_isError(
+            ZSTD_DCtx_reset(m_zstd, ZSTD_reset_session_only));
+    }
+#endif
+}
+
+std::uint64_t LogDecompressor::Decoder::read(char *data, std::uint64_t size) {
+    if (m_format == Format::Gzip) {
+        return inflateGzip(data, size);
+    }
+    if (m_format == Format::Zstd) {
+        return decompressZstd(data, size);
+    }
+    m_failed = true;
+    return 0;
+}
+
+const LogText &LogDecompressor::Decoder::input() {
+    if (m_position >= m_input.end() || m_position < m_input.begin()) {
+        m_input = m_compressed.text(m_position, m_position + InputBytes);
+    }
+    return m_input;
+}
+
+std::uint64_t LogDecompressor::Decoder::inflateGzip(char *data,
+                                                    std::uint64_t size) {
+#if defined(LOGREADER_ZLIB)
+    std::uint64_t produced = 0;
+    while (produced < size && !m_atEnd && !m_failed) {
+        const auto &text = input();
+        const auto inputBytes = static_cast<uInt>(text.end() - m_position);
+        const auto outputBytes =
+            static_cast<uInt>(std::min(size - produced, MaxStepBytes));
+        m_zlib.next_in =
+            reinterpret_cast<Bytef *>(const_cast<char *>(text.at(m_position)));
+        m_zlib.avail_in = inputBytes;
+        m_zlib.next_out = reinterpret_cast<Bytef *>(data + produced);
+        m_zlib.avail_out = outputBytes;
+        // stopping at block boundaries lets loading record checkpoints
+        auto result = inflate(&m_zlib, m_recording ? Z_BLOCK : Z_NO_FLUSH);
+        const auto consumed = inputBytes - m_zlib.avail_in;
+        const auto written = outputBytes - m_zlib.avail_out;
+        m_position += consumed;
+        m_output += written;
+        produced += written;
+        if (result == Z_STREAM_END) {
+            if (m_raw) {
+                m_position += 8;  // the trailer raw inflate leaves
+            }
+            // rotated logs are often concatenated, padding ends the text
+            if (!isGzipMember(m_compressed.text(m_position, m_position + 2))) {
+                m_atEnd = true;
+            } else {
+                m_raw = false;
+                m_failed = inflateReset2(&m_zlib, 15 + 16) != Z_OK;
+            }
+            continue;
+        }
+        // without input inflate still flushes what it holds, no progress
+        // at all means the member is truncated
+        if ((result != Z_OK && result != Z_BUF_ERROR) ||
+            (consumed == 0 && written == 0)) {
+            m_failed = true;
+            break;
+        }
+        // a block boundary, not the end of the last block
+        if (m_recording && (m_zlib.data_type & 128) != 0 &&
+            (m_zlib.data_type & 64) == 0 &&
+            m_output >= m_lastCheckpoint + RestartSpan) {
+            Checkpoint checkpoint{m_output, m_position, m_zlib.data_type & 7,
+                                  std::vector<unsigned char>(WindowBytes)};
+            uInt windowBytes = 0;
+            inflateGetDictionary(&m_zlib, checkpoint.window.data(),
+                                 &windowBytes);
+            checkpoint.window.resize(windowBytes);
+            m_found.push_back(std::move(checkpoint));
+            m_lastCheckpoint = m_output;
+        }
+    }
+    return produced;
+#else
+    (void)data;
+    (void)size;
+    m_failed = true;
+    return 0;
+#endif
+}
+
+std::uint64_t LogDecompressor::Decoder::decompressZstd(char *data,
+                                                       std::uint64_t size) {
+#if defined(LOGREADER_ZSTD)
+    if (m_zstd == nullptr) {
+        m_failed = true;
+        return 0;
+    }
+    ZSTD_outBuffer output{data, static_cast<std::size_t>(size), 0};
+    while (output.pos < size && !m_atEnd && !m_failed) {
+        const auto &text = input();
+        const auto inputBytes = text.end() - m_position;
+        if (inputBytes == 0 && m_frameEnd) {
+            m_atEnd = true;
+            break;
+        }
+        ZSTD_inBuffer buffer{text.at(m_position),
+                             static_cast<std::size_t>(inputBytes), 0};
+        const auto written = output.pos;
+        auto result = ZSTD_decompressStream(m_zstd, &output, &buffer);
+        if (ZSTD_isError(result)) {
+            m_failed = true;
+            break;
+        }
+        m_position += buffer.pos;
+        m_output += output.pos - written;
+        m_frameEnd = result == 0;
+        if (inputBytes == 0 && output.pos == written) {
+            m_failed = true;  // truncated inside a frame
+            break;
+        }
+        if (m_recording && m_frameEnd &&
+            m_output >= m_lastCheckpoint + RestartSpan) {
+            m_found.push_back({m_output, m_position, 0, {}});
+            m_lastCheckpoint = m_output;
+        }
+    }
+    return output.pos;
+#else
+    (void)data;
+    (void)size;
+    m_failed = true;
+    return 0;
+#endif
+}
+
+LogDecompressor::Format LogDecompressor::formatOf(const LogFile &file) {
+    const auto head = file.text(0, 4);
+    if (isGzipMember(head)) {
+        return Format::Gzip;
+    }
+    if (isZstdFrame(head)) {
+        return Format::Zstd;
+    }
+    return Format::None;
+}
+
+bool LogDecompressor::isBuiltIn(Format format) {
+#if defined(LOGREADER_ZLIB)
+    if (format == Format::Gzip) {
+        return true;
+    }
+#endif
+#if defined(LOGREADER_ZSTD)
+    if (format == Format::Zstd) {
+        return true;
+    }
+#endif
+    return format == Format::None;
+}
+
+LogDecompressor::LogDecompressor(std::shared_ptr<const LogFile> compressed)
+    : m_compressed(std::move(compressed)),
+      m_format(formatOf(*m_compressed)),
+      m_stream(std::make_unique<Decoder>(*m_compressed, m_format, true)),
+      m_consumed(0),
+      m_atEnd(false),
+      m_size(0),
+      m_reader(std::make_unique<Decoder>(*m_compressed, m_format, false)) {
+    m_checkpoints.push_back({0, 0, 0, {}});
+    if (m_format == Format::Zstd) {
+        readSeekTable();
+    }
+    m_stream->start(m_checkpoints.front());
+}
+
+LogDecompressor::~LogDecompressor() = default;
+
+bool LogDecompressor::decompress(std::uint64_t keepFrom, std::uint64_t bytes) {
+    if (m_atEnd) {
+        return true;
+    }
+    HOT_PATH_SCOPE("LogDecompressor::decompress");
+    const std::uint64_t size = m_size;
+    // the unfinished page stays so that it can be stored once finished
+    keepFrom = std::max(std::min(keepFrom, size - size % PageBytes),
+                        m_window.begin());
+    const auto kept = size - keepFrom;
+    bytes = std::max<std::uint64_t>(bytes, 1);
+    std::shared_ptr<char[]> buffer(new char[kept + bytes]);
+    if (kept != 0) {
+        std::memcpy(buffer.get(), m_window.at(keepFrom), kept);
+    }
+    const auto produced = m_stream->read(buffer.get() + kept, bytes);
+    const bool ok = !m_stream->failed();
+    m_consumed = m_stream->position();
+    m_atEnd = m_stream->atEnd() || !ok;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &checkpoint : m_stream->takeCheckpoints()) {
+            if (checkpoint.output > m_checkpoints.back().output) {
+                m_checkpoints.push_back(std::move(checkpoint));
+            }
+        }
+        const auto data = buffer.get();
+        m_window = LogText(data, keepFrom, size + produced, std::move(buffer));
+        m_size = size + produced;
+        storePages(size, size + produced);
+    }
+    if (!ok) {
+        Logger::error("Failed to decompress log after {} bytes: {}",
+                      size + produced, m_compressed->fileName().toStdString());
+    }
+    return ok;
+}
+
+LogText LogDecompressor::text(std::uint64_t begin, std::uint64_t end) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    end = std::min<std::uint64_t>(end, m_size);
+    begin = std::min(begin, end);
+    if (m_window.contains(begin, end)) {
+        return m_window.slice(begin, end);
+    }
+    if (begin == end) {
+        return LogText(nullptr, begin, end);
+    }
+    if (begin / PageBytes == (end - 1) / PageBytes) {
+        return page(begin / PageBytes).slice(begin, end);
+    }
+    // across pages, the tail may come from the window
+    std::shared_ptr<char[]> buffer(new char[end - begin]);
+    for (auto position = begin; position < end;) {
+        const auto part = m_window.contains(position, end)
+                              ? m_window
+                              : page(position / PageBytes);
+        const auto partEnd = std::min(end, part.end());
+        std::memcpy(buffer.get() + (position - begin), part.at(position),
+                    partEnd - position);
+        position = partEnd;
+    }
+    const auto data = buffer.get();
+    return LogText(data, begin, end, std::move(buffer));
+}
+
+// a seekable zstd file ends in a skippable frame listing the compressed and
+// decompressed size of each frame, which makes every frame a checkpoint
+void LogDecompressor::readSeekTable() {
+    constexpr std::uint32_t SkippableMagic = 0x184d2a5eu;
+    constexpr std::uint32_t SeekTableMagic = 0x8f92eab1u;
+    constexpr std::uint64_t HeaderBytes = 8;
+    constexpr std::uint64_t FooterBytes = 9;
+    const auto fileSize = static_cast<std::uint64_t>(m_compressed->size());
+    if (fileSize < HeaderBytes + FooterBytes) {
+        return;
+    }
+    const auto footer = m_compressed->text(fileSize - FooterBytes, fileSize);
+    const auto frames = readLittleEndian32(footer.data());
+    const auto descriptor = static_cast<unsigned char>(footer.data()[4]);
+    if (readLittleEndian32(footer.data() + 5) != SeekTableMagic ||
+        (descriptor & 0x7c) != 0) {
+        return;
+    }
+    // entries have a checksum after both sizes when bit 7 is set
+    const std::uint64_t entryBytes = (descriptor & 0x80) != 0 ? 12 : 8;
+    const auto tableBytes = HeaderBytes + frames * entryBytes + FooterBytes;
+    if (tableBytes > fileSize) {
+        return;
+    }
+    const auto table = m_compressed->text(fileSize - tableBytes, fileSize);
+    if (readLittleEndian32(table.data()) != SkippableMagic ||
+        readLittleEndian32(table.data() + 4) != tableBytes - HeaderBytes) {
+        return;
+    }
+    std::vector<Checkpoint> checkpoints;
+    std::uint64_t input = 0;
+    std::uint64_t output = 0;
+    for (std::uint64_t frame = 0; frame < frames; frame++) {
+        const auto entry = table.data() + HeaderBytes + frame * entryBytes;
+        input += readLittleEndian32(entry);
+        output += readLittleEndian32(entry + 4);
+        if (frame + 1 < frames &&
+            (checkpoints.empty() || output > checkpoints.back().output)) {
+            checkpoints.push_back({output, input, 0, {}});
+        }
+    }
+    if (input != fileSize - tableBytes) {
+        Logger::warn("Seek table does not match its frames: {}",
+                     m_compressed->fileName().toStdString());
+        return;
+    }
+    m_checkpoints.insert(m_checkpoints.end(), checkpoints.begin(),
+                         checkpoints.end());
+    Logger::debug("Seek table read: {} frames", frames);
+}
+
+const LogDecompressor::Checkpoint &LogDecompressor::checkpointBefore(
+    std::uint64_t offset) const {
+    auto after = std::upper_bound(
+        m_checkpoints.begin(), m_checkpoints.end(), offset,
+        [](std::uint64_t offset, const Checkpoint &checkpoint) {
+            return offset < checkpoint.output;
+        });
+    return *(after - 1);
+}
+
+void LogDecompressor::storePages(std::uint64_t begin, std::uint64_t end) {
+    // pages finished in [begin, end), the last one also when it ends short
+    const auto first = begin / PageBytes;
+    const auto last = m_atEnd ? (end + PageBytes - 1) / PageBytes
+                              : end / PageBytes;
+    for (auto index = first; index < last; index++) {
+        const auto pageBegin = index * PageBytes;
+        const auto pageEnd = std::min(pageBegin + PageBytes, end);
+        if (pageBegin - checkpointBefore(pageBegin).output <= MaxRestartBytes) {
+            continue;
+        }
+        if (m_storedPages.size() <= index) {
+            m_storedPages.resize(index + 1);
+        }
+        m_storedPages[index] = packPage(m_window.view(pageBegin, pageEnd));
+    }
+}
+
+LogText LogDecompressor::page(std::uint64_t index) const {
+    const auto begin = index * PageBytes;
+    const auto end = std::min<std::uint64_t>(begin + PageBytes, m_size);
+    for (auto cached = m_pages.begin(); cached != m_pages.end(); ++cached) {
+        if (cached->begin() != begin) {
+            continue;
+        }
+        auto page = *cached;
+        m_pages.erase(cached);
+        // a page read before it was finished is read again
+        if (page.end() < end) {
+            break;
+        }
+        m_pages.push_back(page);
+        return page;
+    }
+    std::shared_ptr<char[]> buffer(new char[end - begin]);
+    if (index >= m_storedPages.size() || m_storedPages[index].empty() ||
+        !unpackPage(m_storedPages[index], buffer.get(), end - begin)) {
+        decodePage(begin, buffer.get(), end - begin);
+    }
+    const auto data = buffer.get();
+    m_pages.emplace_back(data, begin, end, std::move(buffer));
+    if (m_pages.size() > CachedPages) {
+        m_pages.erase(m_pages.begin());
+    }
+    return m_pages.back();
+}
+
+void LogDecompressor::decodePage(std::uint64_t begin, char *data,
+                                 std::uint64_t size) const {
+    HOT_PATH_SCOPE("LogDecompressor::decodePage");
+    const auto &checkpoint = checkpointBefore(begin);
+    // reading on is cheaper unless a checkpoint lies in between
+    if (m_reader->failed() || m_reader->atEnd() ||
+        m_reader->output() > begin ||
+        m_reader->output() < checkpoint.output) {
+        m_reader->start(checkpoint);
+    }
+    // the page is scratch space until begin
+    while (m_reader->output() < begin && !m_reader->failed() &&
+           !m_reader->atEnd()) {
+        m_reader->read(data, std::min(size, begin - m_reader->output()));
+    }
+    std::uint64_t decoded = 0;
+    if (m_reader->output() == begin) {
+        decoded = m_reader->read(data, size);
+    }
+    if (decoded < size) {
+        // the file changed since it was loaded
+        std::memset(data + decoded, 0, size - decoded);
+        Logger::warn("Failed to decompress log again at {}: {}", begin,
+                     m_compressed->fileName().toStdString());
+    }
+}
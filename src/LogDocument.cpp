@@ -0,0 +1,30 @@
+#include <LogDocument.h>
+
+#include <utility>
+
+LogDocument::LogDocument(std::shared_ptr<const LogFile> source,
+                         std::shared_ptr<const LogFile> logFile,
+                         std::uint64_t generation, LineIndex lineIndex,
+                         LogTable logTable, TimeIndex timeIndex,
+                         bool complete)
+    : m_source(std::move(source)),
+      m_logFile(std::move(logFile)),
+      m_generation(generation),
+      m_lineIndex(std::move(lineIndex)),
+      m_logTable(std::move(logTable)),
+      m_timeIndex(std::move(timeIndex)),
+      m_complete(complete) {}
+
+LogText LogDocument::line(std::size_t index) const {
+    auto text = m_logFile->text(m_lineIndex.lineBegin(index),
+                                m_lineIndex.lineEnd(index));
+    auto end = text.end();
+    // strip line ending, logs written on windows end with "\r\n"
+    if (end > text.begin() && *text.at(end - 1) == '\n') {
+        end--;
+    }
+    if (end > text.begin() && *text.at(end - 1) == '\r') {
+        end--;
+    }
+    return text.slice(text.begin(), end);
+}
@@ -0,0 +1,141 @@
+#include <LogDecompressor.h>
+#include <LogFile.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+// texts of a mapped file share the mapping, it is unmapped with the last
+struct Mapping {
+    explicit Mapping(const QString &fileName) : file(fileName) {}
+    ~Mapping() {
+        if (data != nullptr) {
+            file.unmap(data);
+        }
+    }
+    QFile file;
+    uchar *data = nullptr;
+};
+}  // namespace
+
+LogFile::LogFile(const QString &fileName, Access access)
+    : m_file(fileName),
+      m_access(access),
+      m_size(0),
+      m_isOpen(false),
+      m_truncated(false) {}
+
+LogFile::LogFile(const QString &fileName,
+                 std::shared_ptr<const LogDecompressor> decompressor)
+    : m_file(fileName),
+      m_access(Access::Read),
+      m_size(0),
+      m_isOpen(true),
+      m_truncated(false),
+      m_decompressor(std::move(decompressor)) {}
+
+LogFile::~LogFile() { close(); }
+
+bool LogFile::open() {
+    if (m_decompressor != nullptr) {
+        return true;  // decompressed text stays open
+    }
+    close();
+    m_truncated = false;
+    if (m_access == Access::Mapped) {
+        auto mapping = std::make_shared<Mapping>(m_file.fileName());
+        if (!mapping->file.open(QIODevice::ReadOnly)) {
+            Logger::error("Failed to open file: {}",
+                          m_file.fileName().toStdString());
+            return false;
+        }
+        const auto size = mapping->file.size();
+        if (size > 0) {
+            mapping->data = mapping->file.map(0, size);
+            if (mapping->data == nullptr) {
+                Logger::error("Failed to map file: {}",
+                              m_file.fileName().toStdString());
+                return false;
+            }
+        }
+        const auto data = reinterpret_cast<const char *>(mapping->data);
+        m_mapped = LogText(data, 0, static_cast<std::uint64_t>(size),
+                           std::move(mapping));
+        m_size = size;
+        m_isOpen = true;
+        Logger::debug("File mapped: {} bytes", m_size);
+        return true;
+    }
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        Logger::error("Failed to open file: {}",
+                      m_file.fileName().toStdString());
+        return false;
+    }
+    m_size = m_file.size();
+    m_isOpen = true;
+    Logger::debug("File opened: {} bytes", m_size);
+    return true;
+}
+
+void LogFile::close() {
+    if (!m_isOpen) {
+        return;
+    }
+    m_file.close();
+    m_mapped = LogText();
+    m_size = 0;
+    m_isOpen = false;
+    m_decompressor.reset();
+}
+
+qint64 LogFile::size() const {
+    if (m_decompressor != nullptr) {
+        return static_cast<qint64>(m_decompressor->size());
+    }
+    return m_size;
+}
+
+LogText LogFile::text(std::uint64_t begin, std::uint64_t end) const {
+    if (m_decompressor != nullptr) {
+        return m_decompressor->text(begin, end);
+    }
+    end = std::min(end, static_cast<std::uint64_t>(m_size));
+    begin = std::min(begin, end);
+    if (m_access == Access::Mapped) {
+        return m_mapped.slice(begin, end);
+    }
+    if (begin == end) {
+        return LogText(nullptr, begin, end);
+    }
+    std::shared_ptr<char[]> buffer(new char[end - begin]);
+    auto position = begin;
+    while (position < end) {
+        const auto bytes = std::min(end - position, MaxReadBytes);
+        qint64 read = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_file.seek(static_cast<qint64>(position))) {
+                read = m_file.read(buffer.get() + (position - begin),
+                                   static_cast<qint64>(bytes));
+            }
+        }
+        if (read < static_cast<qint64>(bytes)) {
+            // the file shrank, what it lost reads as zeros like a mapping
+            // of a hole would
+            const auto kept = static_cast<std::uint64_t>(std::max<qint64>(
+                read, 0));
+            std::memset(buffer.get() + (position - begin) + kept, 0,
+                        end - position - kept);
+            if (!m_truncated.exchange(true)) {
+                Logger::warn("Log file shrank while reading: {}",
+                             m_file.fileName().toStdString());
+            }
+            break;
+        }
+        position += bytes;
+    }
+    const auto data = buffer.get();
+    return LogText(data, begin, end, std::move(buffer));
+}
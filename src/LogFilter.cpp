@@ -0,0 +1,413 @@
+#include <HotPath.h>
+#include <LogFilter.h>
+#include <Simd.h>
+
+#include <algorithm>
+
+namespace {
+// lines before the first record header have a level of their own that is
+// always checked, no level checkbox hides them
+constexpr std::uint8_t HeaderlessLevel = LogLevelCount;
+constexpr std::uint8_t HeaderlessBit = 1u << HeaderlessLevel;
+constexpr std::uint8_t AllLevels = 0x3f | HeaderlessBit;
+
+// bit i is set when row i of a block of 32 rows has a checked level
+using LevelMask32 = std::uint32_t (*)(const std::uint8_t *, std::uint8_t);
+
+#if !defined(LOGREADER_SIMD_X86)
+std::uint32_t levelMask32Scalar(const std::uint8_t *levels,
+                                std::uint8_t levelMask) {
+    std::uint32_t accepted = 0;
+    for (int i = 0; i < 32; i++) {
+        if (levels[i] < 8 && (levelMask >> levels[i]) & 1) {
+            accepted |= 1u << i;
+        }
+    }
+    return accepted;
+}
+#else
+std::uint32_t levelMask32Sse2(const std::uint8_t *levels,
+                              std::uint8_t levelMask) {
+    auto low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels));
+    auto high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(levels + 16));
+    auto acceptedLow = _mm_setzero_si128();
+    auto acceptedHigh = _mm_setzero_si128();
+    for (int level = 0; level <= HeaderlessLevel; level++) {
+        if ((levelMask >> level) & 1) {
+            auto value = _mm_set1_epi8(static_cast<char>(level));
+            acceptedLow =
+                _mm_or_si128(acceptedLow, _mm_cmpeq_epi8(low, value));
+            acceptedHigh =
+                _mm_or_si128(acceptedHigh, _mm_cmpeq_epi8(high, value));
+        }
+    }
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(acceptedLow)) |
+           static_cast<std::uint32_t>(_mm_movemask_epi8(acceptedHigh)) << 16;
+}
+
+LOGREADER_TARGET_AVX2
+std::uint32_t levelMask32Avx2(const std::uint8_t *levels,
+                              std::uint8_t levelMask) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels));
+    auto accepted = _mm256_setzero_si256();
+    for (int level = 0; level <= HeaderlessLevel; level++) {
+        if ((levelMask >> level) & 1) {
+            auto value = _mm256_set1_epi8(static_cast<char>(level));
+            accepted =
+                _mm256_or_si256(accepted, _mm256_cmpeq_epi8(block, value));
+        }
+    }
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(accepted));
+}
+#endif
+
+// mask of the bits [first, last) of word, last - first in [1, 64]
+std::uint64_t bitRange(std::size_t first, std::size_t last) {
+    auto count = last - first;
+    auto bits = count == 64 ? ~std::uint64_t(0)
+                            : (std::uint64_t(1) << count) - 1;
+    return bits << (first & 63);
+}
+
+LevelMask32 selectLevelMask32() {
+#if defined(LOGREADER_SIMD_X86)
+    return Simd::hasAvx2() ? levelMask32Avx2 : levelMask32Sse2;
+#else
+    return levelMask32Scalar;
+#endif
+}
+}  // namespace
+
+LogFilter::LogFilter()
+    : m_levelMask(AllLevels),
+      m_classCount(0),
+      m_uncheckedClassCount(0),
+      m_templateCount(0),
+      m_uncheckedTemplateCount(0),
+      m_lineMatches(nullptr),
+      m_timeIndex(nullptr),
+      m_timeFrom(0),
+      m_timeTo(0),
+      m_postedRecords(0),
+      m_levelPostings(LogLevelCount) {}
+
+void LogFilter::reset() {
+    m_levelMask = AllLevels;
+    m_classCount = 0;
+    m_uncheckedClassCount = 0;
+    m_classBits.clear();
+    m_templateCount = 0;
+    m_uncheckedTemplateCount = 0;
+    m_templateBits.clear();
+    m_lineMatches = nullptr;
+    m_timeIndex = nullptr;
+    m_recordMatches.clear();
+    m_rowLevels.clear();
+    m_rowClasses.clear();
+    m_rowTemplates.clear();
+    m_records.clear();
+    m_postedRecords = 0;
+    m_levelPostings.assign(LogLevelCount, {});
+    m_classPostings.clear();
+    m_templatePostings.clear();
+    m_visibleLines.reset(0, false);
+}
+
+void LogFilter::index(const LogTable &table) {
+    HOT_PATH_SCOPE("LogFilter::index");
+    const auto rows = table.size();
+    const std::uint32_t classCount = table.classes.size();
+    m_classBits.resize((classCount + 63) / 64, 0);
+    for (auto classId = m_classCount; classId < classCount; classId++) {
+        m_classBits[classId >> 6] |= std::uint64_t(1) << (classId & 63);
+    }
+    m_classCount = classCount;
+    m_classPostings.resize(classCount);
+
+    // continue the record of the last indexed row, records not mined yet
+    // have no template
+    const auto firstRow = m_rowLevels.size();
+    auto level = firstRow == 0 ? HeaderlessLevel : m_rowLevels.back();
+    auto classId = firstRow == 0 ? LogTable::NoClass : m_rowClasses.back();
+    auto templateId =
+        firstRow == 0 ? LogTable::NoTemplate : m_rowTemplates.back();
+    auto record = firstRow == 0 ? 0 : table.recordOf(firstRow - 1);
+    m_rowLevels.resize(rows);
+    m_rowClasses.resize(rows);
+    m_rowTemplates.resize(rows);
+    for (auto row = firstRow; row < rows; row++) {
+        if (table.levels[row] != LogTable::NoLevel) {
+            while (table.recordBegin(record) < row) {
+                record++;
+            }
+            level = table.levels[row];
+            classId = table.classIds[row];
+            templateId = record < table.templateIds.size()
+                             ? table.templateIds[record]
+                             : LogTable::NoTemplate;
+        }
+        m_rowLevels[row] = level;
+        m_rowClasses[row] = classId;
+        m_rowTemplates[row] = templateId;
+    }
+
+    m_records = table.records;
+    for (; m_postedRecords < m_records.size(); m_postedRecords++) {
+        auto record = static_cast<std::uint32_t>(m_postedRecords);
+        auto header = m_records[record];
+        if (m_rowLevels[header] != HeaderlessLevel) {
+            m_levelPostings[m_rowLevels[header]].push_back(record);
+        }
+        if (m_rowClasses[header] != LogTable::NoClass) {
+            m_classPostings[m_rowClasses[header]].push_back(record);
+        }
+        auto templateId = m_rowTemplates[header];
+        if (templateId != LogTable::NoTemplate) {
+            if (templateId >= m_templateCount) {
+                addTemplates(templateId + 1);
+            }
+            m_templatePostings[templateId].push_back(record);
+        }
+    }
+
+    // the last record may have grown, it is evaluated again as a whole
+    m_visibleLines.resize(rows);
+    if (firstRow == 0) {
+        evaluate();
+    } else {
+        evaluate(m_records[table.recordOf(firstRow - 1)]);
+    }
+}
+
+void LogFilter::truncate(const LogTable &table) {
+    const auto rows = table.size();
+    if (rows >= m_rowLevels.size()) {
+        return;
+    }
+    // the records dropped are the last ones of their posting lists
+    const auto records = table.recordCount();
+    for (auto record = m_postedRecords; record > records; record--) {
+        const auto header = m_records[record - 1];
+        if (m_rowLevels[header] != HeaderlessLevel) {
+            m_levelPostings[m_rowLevels[header]].pop_back();
+        }
+        if (m_rowClasses[header] != LogTable::NoClass) {
+            m_classPostings[m_rowClasses[header]].pop_back();
+        }
+        if (m_rowTemplates[header] != LogTable::NoTemplate) {
+            m_templatePostings[m_rowTemplates[header]].pop_back();
+        }
+    }
+    m_postedRecords = std::min(m_postedRecords, records);
+    // templates only they had are gone, their ids start checked again
+    while (m_templateCount != 0 &&
+           m_templatePostings[m_templateCount - 1].empty()) {
+        const auto id = --m_templateCount;
+        const auto bit = std::uint64_t(1) << (id & 63);
+        if ((m_templateBits[id >> 6] & bit) == 0) {
+            m_uncheckedTemplateCount--;
+        }
+        m_templateBits[id >> 6] &= ~bit;
+        m_templatePostings.pop_back();
+    }
+    m_records = table.records;
+    m_rowLevels.resize(rows);
+    m_rowClasses.resize(rows);
+    m_rowTemplates.resize(rows);
+    m_visibleLines.resize(rows);
+}
+
+void LogFilter::setLevelChecked(LogLevel level, bool checked) {
+    auto index = static_cast<std::size_t>(level);
+    if (isLevelChecked(static_cast<std::uint8_t>(index)) == checked) {
+        return;
+    }
+    HOT_PATH_SCOPE("LogFilter::setLevelChecked");
+    m_levelMask ^= static_cast<std::uint8_t>(1u << index);
+    for (auto record : m_levelPostings[index]) {
+        auto header = m_records[record];
+        if (isClassChecked(m_rowClasses[header]) &&
+            isTemplateChecked(m_rowTemplates[header]) &&
+            isLineMatched(header) && isTimeMatched(header)) {
+            setRecordVisible(record, checked);
+        }
+    }
+    m_visibleLines.updateRanks();
+}
+
+void LogFilter::setAllLevelsChecked(bool checked) {
+    m_levelMask = checked ? AllLevels : HeaderlessBit;
+    evaluate();
+}
+
+void LogFilter::setClassChecked(std::uint32_t classId, bool checked) {
+    if (classId >= m_classCount || isClassChecked(classId) == checked) {
+        return;
+    }
+    HOT_PATH_SCOPE("LogFilter::setClassChecked");
+    m_classBits[classId >> 6] ^= std::uint64_t(1) << (classId & 63);
+    checked ? m_uncheckedClassCount-- : m_uncheckedClassCount++;
+    for (auto record : m_classPostings[classId]) {
+        auto header = m_records[record];
+        if (isLevelChecked(m_rowLevels[header]) &&
+            isTemplateChecked(m_rowTemplates[header]) &&
+            isLineMatched(header) && isTimeMatched(header)) {
+            setRecordVisible(record, checked);
+        }
+    }
+    m_visibleLines.updateRanks();
+}
+
+void LogFilter::setAllClassesChecked(bool checked) {
+    std::fill(m_classBits.begin(), m_classBits.end(),
+              checked ? ~std::uint64_t(0) : 0);
+    m_uncheckedClassCount = checked ? 0 : m_classCount;
+    evaluate();
+}
+
+void LogFilter::setTemplateChecked(std::uint32_t templateId, bool checked) {
+    if (templateId >= m_templateCount ||
+        isTemplateChecked(templateId) == checked) {
+        return;
+    }
+    HOT_PATH_SCOPE("LogFilter::setTemplateChecked");
+    m_templateBits[templateId >> 6] ^= std::uint64_t(1) << (templateId & 63);
+    checked ? m_uncheckedTemplateCount-- : m_uncheckedTemplateCount++;
+    for (auto record : m_templatePostings[templateId]) {
+        auto header = m_records[record];
+        if (isLevelChecked(m_rowLevels[header]) &&
+            isClassChecked(m_rowClasses[header]) &&
+            isLineMatched(header) && isTimeMatched(header)) {
+            setRecordVisible(record, checked);
+        }
+    }
+    m_visibleLines.updateRanks();
+}
+
+void LogFilter::setAllTemplatesChecked(bool checked) {
+    std::fill(m_templateBits.begin(), m_templateBits.end(),
+              checked ? ~std::uint64_t(0) : 0);
+    m_uncheckedTemplateCount = checked ? 0 : m_templateCount;
+    evaluate();
+}
+
+void LogFilter::setLineMatches(const std::vector<std::uint64_t> *matches) {
+    m_lineMatches = matches;
+    evaluate();
+}
+
+void LogFilter::setTimeRange(const TimeIndex *timeIndex, std::int64_t from,
+                             std::int64_t to) {
+    m_timeIndex = timeIndex;
+    m_timeFrom = from;
+    m_timeTo = to;
+    evaluate();
+}
+
+void LogFilter::addTemplates(std::uint32_t templateCount) {
+    m_templateBits.resize((templateCount + 63) / 64, 0);
+    for (auto id = m_templateCount; id < templateCount; id++) {
+        m_templateBits[id >> 6] |= std::uint64_t(1) << (id & 63);
+    }
+    m_templateCount = templateCount;
+    m_templatePostings.resize(templateCount);
+}
+
+void LogFilter::setRecordVisible(std::uint32_t record, bool visible) {
+    auto end = recordEnd(record);
+    for (auto line = m_records[record]; line < end; line++) {
+        m_visibleLines.set(line, visible);
+    }
+}
+
+void LogFilter::matchRecords(std::size_t firstRecord) {
+    const auto &matches = *m_lineMatches;
+    m_recordMatches.resize(matches.size(), 0);
+    for (auto record = firstRecord; record < m_records.size(); record++) {
+        const std::size_t begin = m_records[record];
+        const auto end = recordEnd(record);
+        if (end == begin + 1) {  // most records are a single line
+            auto bit = std::uint64_t(1) << (begin & 63);
+            auto &word = m_recordMatches[begin >> 6];
+            word = (word & ~bit) | (matches[begin >> 6] & bit);
+            continue;
+        }
+        bool matched = false;
+        for (auto line = begin; line < end && !matched;) {
+            auto wordEnd = std::min(end, (line | 63) + 1);
+            matched = (matches[line >> 6] & bitRange(line, wordEnd)) != 0;
+            line = wordEnd;
+        }
+        for (auto line = begin; line < end;) {
+            auto wordEnd = std::min(end, (line | 63) + 1);
+            auto bits = bitRange(line, wordEnd);
+            auto &word = m_recordMatches[line >> 6];
+            word = matched ? word | bits : word & ~bits;
+            line = wordEnd;
+        }
+    }
+}
+
+void LogFilter::evaluate(std::size_t firstRow) {
+    HOT_PATH_SCOPE("LogFilter::evaluate");
+    if (m_lineMatches != nullptr && !m_records.empty()) {
+        auto firstRecord = std::upper_bound(m_records.begin(),
+                                            m_records.end(), firstRow) -
+                           m_records.begin();
+        matchRecords(firstRecord == 0 ? 0 : firstRecord - 1);
+    }
+    static const auto levelMask32 = selectLevelMask32();
+    const auto rows = m_rowLevels.size();
+    const auto levels = m_rowLevels.data();
+    const auto classes = m_rowClasses.data();
+    const auto templates = m_rowTemplates.data();
+    const bool checkClasses = m_uncheckedClassCount != 0;
+    const bool checkTemplates = m_uncheckedTemplateCount != 0;
+
+    auto acceptedRows = [&](std::size_t row) {
+        auto accepted = levelMask32(levels + row, m_levelMask);
+        if (checkClasses || checkTemplates) {
+            for (auto bits = accepted; bits != 0; bits &= bits - 1) {
+                auto bit = Simd::countTrailingZeros(bits);
+                if (!isClassChecked(classes[row + bit]) ||
+                    !isTemplateChecked(templates[row + bit])) {
+                    accepted &= ~(1u << bit);
+                }
+            }
+        }
+        return accepted;
+    };
+
+    // blocks of the time index entirely inside or outside the range are
+    // decided without reading their timestamps
+    auto matchedRows = [&](std::size_t row) {
+        auto bits = m_lineMatches == nullptr ? ~std::uint64_t(0)
+                                             : m_recordMatches[row / 64];
+        if (m_timeIndex != nullptr && bits != 0) {
+            bits &= m_timeIndex->rangeBits(row / 64, m_timeFrom, m_timeTo);
+        }
+        return bits;
+    };
+
+    auto row = firstRow - firstRow % 64;
+    for (; row + 64 <= rows; row += 64) {
+        m_visibleLines.setWord(
+            row / 64,
+            (acceptedRows(row) |
+             static_cast<std::uint64_t>(acceptedRows(row + 32)) << 32) &
+                matchedRows(row));
+    }
+    if (row < rows) {
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; row + i < rows; i++) {
+            if (isLevelChecked(levels[row + i]) &&
+                isClassChecked(classes[row + i]) &&
+                isTemplateChecked(templates[row + i])) {
+                bits |= std::uint64_t(1) << i;
+            }
+        }
+        m_visibleLines.setWord(row / 64, bits & matchedRows(row));
+    }
+    m_visibleLines.updateRanks();
+}
@@ -0,0 +1,86 @@
+#include <HotPath.h>
+#include <LogHistogram.h>
+
+#include <algorithm>
+
+LogHistogram::LogHistogram()
+    : m_rowCount(0), m_origin(0), m_shift(InitialShift), m_pyramid(1) {}
+
+void LogHistogram::clear() {
+    m_rowCount = 0;
+    m_origin = 0;
+    m_shift = InitialShift;
+    m_pyramid.assign(1, {});
+}
+
+void LogHistogram::index(const LogTable &table) {
+    HOT_PATH_SCOPE("LogHistogram::index");
+    const auto rows = table.size();
+    const auto timestamps = table.timestamps.data();
+    const auto levels = table.levels.data();
+    auto firstChanged = m_pyramid.front().size();
+    for (auto row = m_rowCount; row < rows; row++) {
+        const auto level = levels[row];
+        if (level == LogTable::NoLevel) {
+            continue;  // continuation lines belong to the record above
+        }
+        if (m_pyramid.front().empty()) {
+            m_origin = timestamps[row];
+        }
+        // records written slightly out of order before the first one fall
+        // into the first bucket
+        auto offset = std::max<std::int64_t>(0, timestamps[row] - m_origin);
+        auto bucket = static_cast<std::size_t>(offset >> m_shift);
+        while (bucket >= MaxBuckets) {
+            coarsen();
+            firstChanged /= 2;
+            bucket /= 2;
+        }
+        auto &base = m_pyramid.front();  // coarsening may move it
+        if (bucket >= base.size()) {
+            base.resize(bucket + 1, Counts());
+        }
+        base[bucket][level]++;
+        firstChanged = std::min(firstChanged, bucket);
+    }
+    m_rowCount = rows;
+    updatePyramid(firstChanged);
+}
+
+std::size_t LogHistogram::levelFor(std::int64_t width) const {
+    std::size_t level = 0;
+    while (level + 1 < m_pyramid.size() && bucketWidth(level) < width) {
+        level++;
+    }
+    return level;
+}
+
+void LogHistogram::coarsen() {
+    updatePyramid(0);
+    if (m_pyramid.size() > 1) {  // a single base bucket stays as it is
+        m_pyramid.erase(m_pyramid.begin());
+    }
+    m_shift++;
+}
+
+void LogHistogram::updatePyramid(std::size_t first) {
+    // every level halves the one below until a single bucket is left
+    for (std::size_t level = 1; m_pyramid[level - 1].size() > 1; level++) {
+        first /= 2;
+        if (level == m_pyramid.size()) {
+            m_pyramid.emplace_back();
+        }
+        const auto &below = m_pyramid[level - 1];
+        auto &buckets = m_pyramid[level];
+        buckets.resize((below.size() + 1) / 2);
+        for (auto bucket = first; bucket < buckets.size(); bucket++) {
+            auto &counts = buckets[bucket];
+            counts = below[2 * bucket];
+            if (2 * bucket + 1 < below.size()) {
+                for (std::size_t i = 0; i < LogLevelCount; i++) {
+                    counts[i] += below[2 * bucket + 1][i];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#include <LogItemDelegate.h>
+#include <LogListModel.h>
+
+#include <QApplication>
+#include <QDateTime>
+#include <QPainter>
+#include <QTextCharFormat>
+#include <QTimeZone>
+#include <cmath>
+
+namespace {
+bool isWordChar(QChar c) { return c.isLetterOrNumber() || c == '_'; }
+
+int textMargin(const QStyleOptionViewItem &option) {
+    auto style = option.widget ? option.widget->style() : QApplication::style();
+    return style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr,
+                              option.widget) +
+           1;
+}
+}  // namespace
+
+LogItemDelegate::LogItemDelegate(QObject *parent)
+    : QStyledItemDelegate(parent),
+      m_timestampColor(QColor(0x2e, 0x8b, 0x57)),
+      m_classColor(Qt::darkMagenta),
+      m_highlightColor(QColor(0xff, 0xeb, 0x3b)),
+      m_repeatColor(Qt::darkCyan),
+      m_layouts(CachedLayouts) {}
+
+void LogItemDelegate::paint(QPainter *painter,
+                            const QStyleOptionViewItem &option,
+                            const QModelIndex &index) const {
+    QStyleOptionViewItem itemOption = option;
+    initStyleOption(&itemOption, index);
+    itemOption.text.clear();
+    auto style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter,
+                       option.widget);
+
+    auto textLayout = layout(option, index);
+    if (textLayout == nullptr || textLayout->lineCount() == 0) {
+        return;
+    }
+    auto selected = option.state & QStyle::State_Selected;
+    auto line = textLayout->lineAt(0);
+    QPointF position(option.rect.left() + textMargin(option),
+                     option.rect.top() +
+                         (option.rect.height() - line.height()) / 2);
+    painter->save();
+    // runs carry their own color, the pen colors the rest of the row
+    painter->setPen(option.palette.color(selected ? QPalette::HighlightedText
+                                                  : QPalette::Text));
+    textLayout->draw(painter, position);
+    auto badge = repeatBadge(index);
+    if (!badge.isEmpty()) {
+        if (!selected) {
+            painter->setPen(m_repeatColor);
+        }
+        auto badgeLeft = position.x() + line.naturalTextWidth() +
+                         option.fontMetrics.averageCharWidth() * 2;
+        painter->drawText(QRectF(badgeLeft, option.rect.top(),
+                                 option.fontMetrics.horizontalAdvance(badge),
+                                 option.rect.height()),
+                          Qt::AlignLeft | Qt::AlignVCenter, badge);
+    }
+    painter->restore();
+}
+
+QSize LogItemDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                const QModelIndex &index) const {
+    auto textLayout = layout(option, index);
+    if (textLayout == nullptr || textLayout->lineCount() == 0) {
+        return QStyledItemDelegate::sizeHint(option, index);
+    }
+    auto line = textLayout->lineAt(0);
+    auto width = static_cast<int>(std::ceil(line.naturalTextWidth())) +
+                 2 * textMargin(option);
+    auto badge = repeatBadge(index);
+    if (!badge.isEmpty()) {
+        width += option.fontMetrics.averageCharWidth() * 2 +
+                 option.fontMetrics.horizontalAdvance(badge);
+    }
+    return QSize(width, static_cast<int>(std::ceil(line.height())));
+}
+
+std::vector<LogItemDelegate::StyleRun> LogItemDelegate::styleRuns(
+    const QString &text, bool hasClass) {
+    std::vector<StyleRun> runs;
+    if (!text.startsWith('[')) {
+        return runs;
+    }
+    auto timestampEnd = text.indexOf(']') + 1;
+    if (timestampEnd <= 0 || timestampEnd >= text.size() ||
+        text[timestampEnd] != '[') {
+        return runs;
+    }
+    auto levelEnd = text.indexOf(']', timestampEnd) + 1;
+    if (levelEnd <= 0) {
+        return runs;
+    }
+    runs.push_back({0, timestampEnd, Field::Timestamp});
+    runs.push_back({timestampEnd, levelEnd - timestampEnd, Field::Level});
+    if (hasClass) {
+        auto classBegin = levelEnd;
+        while (classBegin < text.size() && text[classBegin] == ' ') {
+            classBegin++;
+        }
+        auto classEnd = classBegin;
+        while (classEnd < text.size() && isWordChar(text[classEnd])) {
+            classEnd++;
+        }
+        if (classEnd > classBegin) {
+            runs.push_back({classBegin, classEnd - classBegin, Field::Class});
+        }
+    }
+    return runs;
+}
+
+void LogItemDelegate::setHighlight(const QRegularExpression &expression) {
+    m_highlight = expression;
+    clearCache();
+}
+
+void LogItemDelegate::clearCache() { m_layouts.clear(); }
+
+const QTextLayout *LogItemDelegate::layout(const QStyleOptionViewItem &option,
+                                           const QModelIndex &index) const {
+    auto lineNumber = index.data(LogListModel::LineRole);
+    if (!lineNumber.isValid()) {
+        return nullptr;
+    }
+    if (option.font != m_layoutFont) {
+        m_layouts.clear();
+        m_layoutFont = option.font;
+    }
+    auto key = lineNumber.toUInt();
+    if (auto cached = m_layouts.object(key)) {
+        return cached;
+    }
+
+    auto textLayout = new QTextLayout(index.data().toString(), option.font);
+    QTextOption textOption;
+    textOption.setWrapMode(QTextOption::NoWrap);
+    textLayout->setTextOption(textOption);
+    QList<QTextLayout::FormatRange> formats;
+    auto level = index.data(LogListModel::LevelRole);
+    if (level.isValid()) {
+        auto hasClass = index.data(LogListModel::ClassRole).isValid();
+        for (const auto &run : styleRuns(textLayout->text(), hasClass)) {
+            QTextLayout::FormatRange format;
+            format.start = run.begin;
+            format.length = run.length;
+            format.format.setForeground(
+                runColor(run, static_cast<LogLevel>(level.toInt())));
+            formats.append(format);
+        }
+    }
+    if (m_highlight.isValid() && !m_highlight.pattern().isEmpty()) {
+        // overlapping ranges are merged, matches keep the run colors
+        auto matches = m_highlight.globalMatch(textLayout->text());
+        while (matches.hasNext()) {
+            auto match = matches.next();
+            if (match.capturedLength() == 0) {
+                continue;
+            }
+            QTextLayout::FormatRange format;
+            format.start = static_cast<int>(match.capturedStart());
+            format.length = static_cast<int>(match.capturedLength());
+            format.format.setBackground(m_highlightColor);
+            formats.append(format);
+        }
+    }
+    if (!formats.isEmpty()) {
+        textLayout->setFormats(formats);
+    }
+    textLayout->beginLayout();
+    textLayout->createLine();
+    textLayout->endLayout();
+    m_layouts.insert(key, textLayout);
+    return textLayout;
+}
+
+QString LogItemDelegate::repeatBadge(const QModelIndex &index) {
+    auto count = index.data(LogListModel::RepeatCountRole);
+    if (!count.isValid()) {
+        return QString();
+    }
+    // down and right pointing triangles like a tree view branch
+    if (index.data(LogListModel::RepeatExpandedRole).toBool()) {
+        return QChar(0x25be) + QString(" %1 repeats").arg(count.toUInt());
+    }
+    auto end = QDateTime::fromMSecsSinceEpoch(
+        index.data(LogListModel::RepeatEndRole).toLongLong() / 1000,
+        QTimeZone::utc());
+    return QChar(0x25b8) + QString(" %1%2 until %3")
+                               .arg(QChar(0x00d7))
+                               .arg(count.toUInt())
+                               .arg(end.toString("HH:mm:ss.zzz"));
+}
+
+QColor LogItemDelegate::runColor(const StyleRun &run, LogLevel level) const {
+    switch (run.field) {
+        case Field::Timestamp:
+            return m_timestampColor;
+        case Field::Level:
+            return QColor(LogLevelColors[static_cast<std::size_t>(level)]);
+        case Field::Class:
+            return m_classColor;
+    }
+    return QColor();
+}
@@ -0,0 +1,155 @@
+#include <HotPath.h>
+#include <LogListModel.h>
+
+#include <algorithm>
+
+LogListModel::LogListModel(QObject *parent) : QAbstractListModel(parent) {}
+
+void LogListModel::clear() {
+    beginResetModel();
+    m_document.reset();
+    m_lines.reset();
+    m_runs.reset();
+    endResetModel();
+}
+
+void LogListModel::setLogDocument(std::shared_ptr<const LogDocument> document,
+                                  std::shared_ptr<const VisibleLines> lines,
+                                  std::shared_ptr<const RepeatRuns> runs) {
+    if (m_document == nullptr ||
+        m_document->generation() != document->generation()) {
+        beginResetModel();
+        m_document = document;
+        m_lines = lines;
+        m_runs = runs;
+        endResetModel();
+        return;
+    }
+    // a record search or repeat folding can show or hide rows above the end
+    // while the document grows, only rows appended behind the shown ones
+    // keep their indices
+    if (!lines->extends(*m_lines)) {
+        m_document = document;
+        replaceLines(lines, runs);
+        return;
+    }
+    // more lines behind the existing rows, which stay as they are
+    auto oldRows = rowCount();
+    auto newRows = static_cast<int>(lines->size());
+    if (newRows > oldRows) {
+        beginInsertRows(QModelIndex(), oldRows, newRows - 1);
+    }
+    m_document = document;
+    m_lines = lines;
+    m_runs = runs;
+    if (newRows > oldRows) {
+        endInsertRows();
+    }
+    if (m_runs != nullptr && newRows > 0) {
+        // the last run may have grown behind an existing row
+        emit dataChanged(index(0), index(newRows - 1));
+    }
+}
+
+void LogListModel::setFilteredLines(
+    std::shared_ptr<const LogDocument> document,
+    std::shared_ptr<const VisibleLines> lines,
+    std::shared_ptr<const RepeatRuns> runs) {
+    if (m_document == nullptr || document != m_document) {
+        return;  // result of a file that is no longer shown
+    }
+    replaceLines(lines, runs);
+}
+
+void LogListModel::replaceLines(std::shared_ptr<const VisibleLines> lines,
+                                std::shared_ptr<const RepeatRuns> runs) {
+    // a layout change instead of a reset keeps the rows the view holds on
+    // to, each moves to its line in the new lines or to the next visible
+    // line when its own was hidden
+    emit layoutAboutToBeChanged();
+    auto from = persistentIndexList();
+    QModelIndexList to;
+    for (const auto &index : from) {
+        auto line = lineAt(index.row());
+        auto row = line < lines->lineCount() ? lines->rowOf(line)
+                                             : lines->size();
+        if (row >= lines->size() && lines->size() > 0) {
+            row = lines->size() - 1;  // no visible line after it
+        }
+        to.append(row < lines->size() ? createIndex(static_cast<int>(row), 0)
+                                      : QModelIndex());
+    }
+    m_lines = lines;
+    m_runs = runs;
+    changePersistentIndexList(from, to);
+    emit layoutChanged();
+}
+
+const RepeatRun *LogListModel::runAt(std::uint32_t line) const {
+    if (m_runs == nullptr) {
+        return nullptr;
+    }
+    auto found = std::lower_bound(
+        m_runs->begin(), m_runs->end(), line,
+        [](const RepeatRun &other, std::uint32_t first) {
+            return other.line < first;
+        });
+    return found != m_runs->end() && found->line == line ? &*found : nullptr;
+}
+
+int LogListModel::rowOf(std::uint32_t line) const {
+    if (m_lines == nullptr || line >= m_lines->lineCount()) {
+        return rowCount();
+    }
+    return static_cast<int>(m_lines->rowOf(line));
+}
+
+int LogListModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() || m_lines == nullptr) {
+        return 0;
+    }
+    return static_cast<int>(m_lines->size());
+}
+
+QVariant LogListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    auto lineNumber = lineAt(index.row());
+    switch (role) {
+        case Qt::DisplayRole: {
+            HOT_PATH_COUNT("LogListModel::data");
+            auto line = m_document->line(lineNumber);
+            return QString::fromUtf8(line.data(), line.size());
+        }
+        case LineRole:
+            return QVariant(lineNumber);
+        case LevelRole: {
+            auto level = m_document->table().levels[lineNumber];
+            return level == LogTable::NoLevel ? QVariant() : QVariant(level);
+        }
+        case ClassRole: {
+            auto classId = m_document->table().classIds[lineNumber];
+            return classId == LogTable::NoClass ? QVariant()
+                                                : QVariant(classId);
+        }
+        case RepeatCountRole: {
+            auto run = runAt(lineNumber);
+            return run == nullptr ? QVariant() : QVariant(run->count);
+        }
+        case RepeatEndRole: {
+            auto run = runAt(lineNumber);
+            if (run == nullptr) {
+                return QVariant();
+            }
+            return QVariant(static_cast<qint64>(
+                m_document->table().timestamps[run->lastLine]));
+        }
+        case RepeatExpandedRole: {
+            auto run = runAt(lineNumber);
+            return run == nullptr ? QVariant() : QVariant(run->expanded);
+        }
+        default:
+            return QVariant();
+    }
+}
@@ -0,0 +1,208 @@
+#include <HotPath.h>
+#include <LogRecordParser.h>
+
+#include <utility>
+
+namespace {
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool isWordChar(char c) {
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '_';
+}
+
+bool readNumber(const char *&current, const char *end, int digits,
+                int &value) {
+    if (end - current < digits) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < digits; i++) {
+        if (!isDigit(current[i])) {
+            return false;
+        }
+        value = value * 10 + (current[i] - '0');
+    }
+    current += digits;
+    return true;
+}
+
+bool expect(const char *&current, const char *end, char c) {
+    if (current == end || *current != c) {
+        return false;
+    }
+    current++;
+    return true;
+}
+
+// days since 1970-01-01 of a proleptic gregorian date
+std::int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear =
+        (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra =
+        yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return static_cast<std::int64_t>(era) * 146097 + dayOfEra - 719468;
+}
+}  // namespace
+
+LogRecordParser::LogRecordParser(LogTable &table)
+    : m_table(table), m_lastTimestamp(0) {}
+
+void LogRecordParser::parse(const LogText &text, const LineIndex &lineIndex,
+                            std::uint64_t firstLine, std::uint64_t lastLine) {
+    HOT_PATH_SCOPE("LogRecordParser::parse");
+    HOT_PATH_ADD("LogRecordParser::lines", lastLine - firstLine);
+    m_table.reserve(m_table.size() + (lastLine - firstLine));
+    for (auto line = firstLine; line < lastLine; line++) {
+        auto begin = text.at(lineIndex.lineBegin(line));
+        auto end = text.at(lineIndex.lineEnd(line));
+        if (end > begin && end[-1] == '\n') {
+            end--;
+        }
+        if (end > begin && end[-1] == '\r') {
+            end--;
+        }
+
+        Header header;
+        const auto row = static_cast<std::uint32_t>(m_table.size());
+        if (parseHeader(begin, end, header)) {
+            m_table.records.push_back(row);
+            m_lastTimestamp = header.timestamp;
+            m_table.timestamps.push_back(header.timestamp);
+            m_table.levels.push_back(header.level);
+            m_table.classIds.push_back(
+                header.className.empty()
+                    ? LogTable::NoClass
+                    : m_table.classes.intern(header.className));
+            m_table.messageOffsets.push_back(text.offsetOf(header.message));
+            m_table.messageLengths.push_back(
+                static_cast<std::uint32_t>(end - header.message));
+        } else {
+            // continuation line, keeps the time of the record it belongs to
+            HOT_PATH_COUNT("LogRecordParser::continuationLines");
+            if (row == 0) {
+                m_table.records.push_back(row);  // lines before any header
+            }
+            m_table.timestamps.push_back(m_lastTimestamp);
+            m_table.levels.push_back(LogTable::NoLevel);
+            m_table.classIds.push_back(LogTable::NoClass);
+            m_table.messageOffsets.push_back(text.offsetOf(begin));
+            m_table.messageLengths.push_back(
+                static_cast<std::uint32_t>(end - begin));
+        }
+    }
+}
+
+bool LogRecordParser::parseHeader(const char *begin, const char *end,
+                                  Header &header) {
+    auto current = begin;
+    if (!expect(current, end, '[') ||
+        !parseTimestamp(current, end, header.timestamp) ||
+        !expect(current, end, ']') || !expect(current, end, '[')) {
+        return false;
+    }
+    auto levelBegin = current;
+    while (current != end && *current != ']') {
+        current++;
+    }
+    if (current == end) {
+        return false;
+    }
+    header.level =
+        parseLevel(std::string_view(levelBegin, current - levelBegin));
+    if (header.level == LogTable::NoLevel) {
+        return false;
+    }
+    current++;  // ']'
+
+    while (current != end && *current == ' ') {
+        current++;
+    }
+    // "Class -- message", "Class - message" or just "message"
+    auto wordBegin = current;
+    auto wordEnd = current;
+    while (wordEnd != end && isWordChar(*wordEnd)) {
+        wordEnd++;
+    }
+    auto separator = wordEnd;
+    while (separator != end && *separator == ' ') {
+        separator++;
+    }
+    if (wordEnd != wordBegin && separator != end && *separator == '-') {
+        header.className = std::string_view(wordBegin, wordEnd - wordBegin);
+        while (separator != end && *separator == '-') {
+            separator++;
+        }
+        while (separator != end && *separator == ' ') {
+            separator++;
+        }
+        header.message = separator;
+    } else {
+        header.className = std::string_view();
+        header.message = wordBegin;
+    }
+    return true;
+}
+
+bool LogRecordParser::parseTimestamp(const char *&current, const char *end,
+                                     std::int64_t &timestamp) {
+    int year, month, day, hour, minute, second;
+    if (!readNumber(current, end, 4, year) || !expect(current, end, '-') ||
+        !readNumber(current, end, 2, month) || !expect(current, end, '-') ||
+        !readNumber(current, end, 2, day) || !expect(current, end, ' ') ||
+        !readNumber(current, end, 2, hour) || !expect(current, end, ':') ||
+        !readNumber(current, end, 2, minute) || !expect(current, end, ':') ||
+        !readNumber(current, end, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    // %e (milli), %f (micro) and %F (nano) fractions are all accepted
+    std::int64_t micros = 0;
+    if (current != end && *current == '.') {
+        current++;
+        int digits = 0;
+        while (current != end && isDigit(*current)) {
+            if (digits < 6) {
+                micros = micros * 10 + (*current - '0');
+            }
+            digits++;
+            current++;
+        }
+        if (digits == 0) {
+            return false;
+        }
+        for (; digits < 6; digits++) {
+            micros *= 10;
+        }
+    }
+    auto seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 +
+                   minute * 60 + second;
+    timestamp = seconds * 1000000 + micros;
+    return true;
+}
+
+std::uint8_t LogRecordParser::parseLevel(std::string_view level) {
+    static const std::pair<std::string_view, LogLevel> names[] = {
+        {"trace", LogLevel::TRACE},     {"debug", LogLevel::DEBUG},
+        {"info", LogLevel::INFO},       {"warning", LogLevel::WARNING},
+        {"warn", LogLevel::WARNING},    {"error", LogLevel::ERROR},
+        {"critical", LogLevel::CRITICAL}};
+    for (const auto &[name, logLevel] : names) {
+        if (name.size() != level.size()) {
+            continue;
+        }
+        bool equal = true;
+        for (std::size_t i = 0; i < name.size() && equal; i++) {
+            equal = (level[i] | 0x20) == name[i];  // ascii case insensitive
+        }
+        if (equal) {
+            return static_cast<std::uint8_t>(logLevel);
+        }
+    }
+    return LogTable::NoLevel;
+}
@@ -0,0 +1,176 @@
+#include <HotPath.h>
+#include <LogSearch.h>
+#include <Logger.h>
+#include <RegexLiteral.h>
+
+#include <algorithm>
+
+namespace {
+// only candidate lines are converted for the regular expression, finding
+// them stays on the raw bytes
+bool matchesRegex(const LogText &text, const LineIndex &lineIndex,
+                  std::size_t line, const QRegularExpression &regex) {
+    auto begin = text.at(lineIndex.lineBegin(line));
+    auto end = text.at(lineIndex.lineEnd(line));
+    if (end > begin && end[-1] == '\n') {
+        end--;
+    }
+    if (end > begin && end[-1] == '\r') {
+        end--;
+    }
+    auto lineText =
+        QString::fromUtf8(begin, static_cast<qsizetype>(end - begin));
+    return regex.match(lineText).hasMatch();
+}
+}  // namespace
+
+LogSearch::LogSearch(ThreadPool &pool)
+    : m_pool(pool), m_active(false), m_isRegex(false), m_lineCount(0) {}
+
+bool LogSearch::setQuery(const std::string &text, bool matchCase,
+                         bool isRegex) {
+    reset();
+    m_active = false;
+    m_isRegex = isRegex;
+    m_regex = QRegularExpression();
+    if (!isRegex) {
+        m_finder = LiteralFinder(text, matchCase);
+        m_active = !text.empty();
+        return true;
+    }
+    m_regex.setPattern(QString::fromStdString(text));
+    m_regex.setPatternOptions(
+        matchCase ? QRegularExpression::NoPatternOption
+                  : QRegularExpression::CaseInsensitiveOption);
+    if (!m_regex.isValid()) {
+        Logger::warn("Invalid search pattern: {}",
+                     m_regex.errorString().toStdString());
+        return false;
+    }
+    m_regex.optimize();  // compiles and JITs the pattern now
+    m_finder = LiteralFinder(RegexLiteral::required(text, matchCase),
+                             matchCase);
+    m_active = !text.empty();
+    Logger::debug("Search pattern literal: {}", m_finder.literal());
+    return true;
+}
+
+void LogSearch::reset() {
+    m_lineCount = 0;
+    m_matches.clear();
+}
+
+void LogSearch::truncate(std::size_t lineCount) {
+    if (lineCount >= m_lineCount) {
+        return;
+    }
+    m_lineCount = lineCount;
+    m_matches.resize((lineCount + 63) / 64);
+    if (lineCount % 64 != 0) {  // update only sets bits
+        m_matches.back() &= (std::uint64_t(1) << (lineCount % 64)) - 1;
+    }
+}
+
+void LogSearch::update(const LogFile &file, const LogText &loaded,
+                       const LineIndex &lineIndex, const TrigramIndex &index) {
+    const auto first = m_lineCount;
+    const auto last = lineIndex.lineCount();
+    if (last <= first) {
+        return;
+    }
+    HOT_PATH_SCOPE("LogSearch::update");
+    m_matches.resize((last + 63) / 64, 0);
+    m_lineCount = last;
+    if (!isActive()) {
+        return;
+    }
+
+    // blocks the index covers completely, every later block is a candidate
+    const auto indexedBlocks = static_cast<std::uint32_t>(
+        std::min(index.lineCount(), last) / TrigramIndex::LinesPerBlock);
+    std::vector<std::uint32_t> blocks;
+    if (indexedBlocks != 0) {
+        blocks = index.candidateBlocks(m_finder.literal());
+        blocks.erase(std::lower_bound(blocks.begin(), blocks.end(),
+                                      indexedBlocks),
+                     blocks.end());
+    }
+    const auto blockCount = static_cast<std::uint32_t>(
+        (last + TrigramIndex::LinesPerBlock - 1) /
+        TrigramIndex::LinesPerBlock);
+    for (auto block = indexedBlocks; block < blockCount; block++) {
+        blocks.push_back(block);
+    }
+    auto begin = std::lower_bound(blocks.begin(), blocks.end(),
+                                  first / TrigramIndex::LinesPerBlock);
+    const auto count = static_cast<std::size_t>(blocks.end() - begin);
+    HOT_PATH_SAMPLE("LogSearch::candidateBlocks", count);
+    // the unsearched lines of blocks [firstBlock, lastBlock), from loaded
+    // or read in one go
+    auto readBlocks = [&](std::uint32_t firstBlock, std::uint32_t lastBlock) {
+        auto textBegin = lineIndex.lineBegin(std::max<std::size_t>(
+            firstBlock * TrigramIndex::LinesPerBlock, first));
+        auto textEnd = lineIndex.lineEnd(
+            std::min<std::size_t>(lastBlock * TrigramIndex::LinesPerBlock,
+                                  last) -
+            1);
+        return loaded.contains(textBegin, textEnd)
+                   ? loaded
+                   : file.text(textBegin, textEnd);
+    };
+    // every block is one word of m_matches, tasks never share a word. A
+    // run of consecutive candidates is read at once
+    m_pool.parallelFor(
+        (count + BlocksPerTask - 1) / BlocksPerTask, [&](std::size_t task) {
+            const auto regex = m_regex;  // a copy for every thread
+            auto taskBegin = begin + task * BlocksPerTask;
+            auto taskEnd = begin + std::min(count, (task + 1) * BlocksPerTask);
+            for (auto run = taskBegin; run != taskEnd;) {
+                auto runEnd = run + 1;
+                while (runEnd != taskEnd && *runEnd == runEnd[-1] + 1) {
+                    ++runEnd;
+                }
+                auto text = readBlocks(*run, runEnd[-1] + 1);
+                for (auto block = run; block != runEnd; ++block) {
+                    auto blockLine = *block * TrigramIndex::LinesPerBlock;
+                    searchBlock(
+                        text, lineIndex, regex, std::max(blockLine, first),
+                        std::min(blockLine + TrigramIndex::LinesPerBlock,
+                                 last));
+                }
+                run = runEnd;
+            }
+        });
+}
+
+void LogSearch::searchBlock(const LogText &text, const LineIndex &lineIndex,
+                            const QRegularExpression &regex,
+                            std::size_t firstLine, std::size_t lastLine) {
+    if (firstLine >= lastLine) {
+        return;
+    }
+    // the whole block is searched at once, a match belongs to the line it
+    // starts in and the search continues on the next line. An empty
+    // literal matches at the start of every line
+    std::uint64_t bits = 0;
+    auto line = firstLine;
+    auto begin = lineIndex.lineBegin(firstLine);
+    const auto end = lineIndex.lineEnd(lastLine - 1);
+    while (begin < end) {
+        auto match = m_finder.find(text.data(), begin - text.begin(),
+                                   end - text.begin()) +
+                     text.begin();
+        if (match == end) {
+            break;
+        }
+        while (lineIndex.lineEnd(line) <= match) {
+            line++;
+        }
+        if (!m_isRegex || matchesRegex(text, lineIndex, line, regex)) {
+            bits |= std::uint64_t(1) << (line % 64);
+        }
+        begin = lineIndex.lineEnd(line);
+        line++;
+    }
+    m_matches[firstLine / 64] |= bits;
+}
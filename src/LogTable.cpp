@@ -0,0 +1,142 @@
+#include <LogTable.h>
+
+#include <algorithm>
+
+void LogTable::reserve(std::size_t rows) {
+    timestamps.reserve(rows);
+    levels.reserve(rows);
+    classIds.reserve(rows);
+    messageOffsets.reserve(rows);
+    messageLengths.reserve(rows);
+}
+
+std::size_t LogTable::recordOf(std::size_t row) const {
+    return std::upper_bound(records.begin(), records.end(), row) -
+           records.begin() - 1;
+}
+
+void LogTable::clear() {
+    timestamps.clear();
+    levels.clear();
+    classIds.clear();
+    messageOffsets.clear();
+    messageLengths.clear();
+    records.clear();
+    templateIds.clear();
+    classes.clear();
+}
+
+void LogTable::truncate(std::size_t rows) {
+    if (rows >= size()) {
+        return;
+    }
+    timestamps.resize(rows);
+    levels.resize(rows);
+    classIds.resize(rows);
+    messageOffsets.resize(rows);
+    messageLengths.resize(rows);
+    while (!records.empty() && records.back() >= rows) {
+        records.pop_back();
+    }
+    if (templateIds.size() > records.size()) {
+        templateIds.resize(records.size());
+    }
+}
+
+void LogTable::append(const LogTable &next) {
+    std::vector<std::uint32_t> classMap(next.classes.size());
+    for (std::uint32_t id = 0; id < next.classes.size(); id++) {
+        classMap[id] = classes.intern(next.classes.name(id));
+    }
+    auto lastTimestamp = timestamps.empty() ? 0 : timestamps.back();
+    auto first = timestamps.size();
+    timestamps.append(next.timestamps.begin(), next.timestamps.end());
+    // continuation rows before the first header of next
+    for (std::size_t row = 0;
+         row < next.size() && next.levels[row] == NoLevel; row++) {
+        timestamps.set(first + row, lastTimestamp);
+    }
+    levels.append(next.levels.begin(), next.levels.end());
+    classIds.reserve(first + next.size());
+    for (std::size_t row = 0; row < next.size(); row++) {
+        auto classId = next.classIds[row];
+        classIds.push_back(classId == NoClass ? NoClass : classMap[classId]);
+    }
+    messageOffsets.append(next.messageOffsets.begin(),
+                          next.messageOffsets.end());
+    messageLengths.append(next.messageLengths.begin(),
+                          next.messageLengths.end());
+    auto nextRecord = next.records.begin();
+    if (first != 0 && nextRecord != next.records.end() && *nextRecord == 0 &&
+        next.levels[0] == NoLevel) {
+        nextRecord++;  // continues the last record here
+    }
+    records.reserve(records.size() + (next.records.end() - nextRecord));
+    for (; nextRecord != next.records.end(); ++nextRecord) {
+        records.push_back(static_cast<std::uint32_t>(first + *nextRecord));
+    }
+}
+
+void LogTable::countLevels(std::size_t firstRow, LevelCounts &counts) const {
+    for (auto row = firstRow; row < levels.size(); row++) {
+        if (levels[row] != NoLevel) {
+            counts[levels[row]]++;
+        }
+    }
+}
+
+void LogTable::save(IndexWriter &writer) const {
+    writer.writeArray(timestamps.data(), timestamps.size());
+    writer.writeArray(levels.data(), levels.size());
+    writer.writeArray(classIds.data(), classIds.size());
+    writer.writeArray(messageOffsets.data(), messageOffsets.size());
+    writer.writeArray(messageLengths.data(), messageLengths.size());
+    writer.writeArray(records.data(), records.size());
+    writer.writeArray(templateIds.data(), templateIds.size());
+    writer.write<std::uint64_t>(classes.size());
+    for (std::uint32_t id = 0; id < classes.size(); id++) {
+        writer.writeString(classes.name(id));
+    }
+}
+
+void LogTable::load(IndexReader &reader, std::uint64_t textSize) {
+    clear();
+    timestamps = reader.readView<std::int64_t>();
+    levels = reader.readView<std::uint8_t>();
+    classIds = reader.readView<std::uint32_t>();
+    messageOffsets = reader.readView<std::uint64_t>();
+    messageLengths = reader.readView<std::uint32_t>();
+    records = reader.readView<std::uint32_t>();
+    templateIds = reader.readView<std::uint32_t>();
+    auto classCount = reader.read<std::uint64_t>();
+    for (std::uint64_t id = 0; id < classCount && reader.ok(); id++) {
+        classes.intern(reader.readString());
+    }
+    const auto rows = size();
+    if (timestamps.size() != rows || classIds.size() != rows ||
+        messageOffsets.size() != rows || messageLengths.size() != rows ||
+        records.size() > rows || templateIds.size() > records.size() ||
+        (rows != 0 && (records.empty() || records.front() != 0)) ||
+        classes.size() != classCount) {
+        reader.fail();
+        return;
+    }
+    // the values are used as indices without further checks
+    for (std::size_t row = 0; row < rows; row++) {
+        auto level = levels[row];
+        auto classId = classIds[row];
+        auto offset = messageOffsets[row];
+        if ((level >= LogLevelCount && level != NoLevel) ||
+            (classId >= classes.size() && classId != NoClass) ||
+            offset > textSize || messageLengths[row] > textSize - offset) {
+            reader.fail();
+            return;
+        }
+    }
+    for (std::size_t record = 1; record < records.size(); record++) {
+        if (records[record] <= records[record - 1] || records[record] >= rows) {
+            reader.fail();
+            return;
+        }
+    }
+}
@@ -1,231 +1,621 @@
+#include <HotPath.h>
 #include <LogTextProcessor.h>
 #include <Logger.h>
 
-#include <QCheckBox>
-#include <QColor>
-#include <QRegularExpression>
+#include <QFileInfo>
+#include <algorithm>
+#include <chrono>
+#include <utility>
 
-LogTextProcessor::LogTextProcessor(QWidget *parent)
+LogTextProcessor::LogTextProcessor(QObject *parent)
     : QObject(parent),
-      m_parent(parent),
-      m_classesFromLog({}),
-      m_classes({}),
-      m_levelsFromLog({}),
-      m_levels({{LogLevel::TRACE, "trace"},
-                {LogLevel::DEBUG, "debug"},
-                {LogLevel::INFO, "info"},
-                {LogLevel::WARNING, "warning"},
-                {LogLevel::ERROR, "error"},
-                {LogLevel::CRITICAL, "critical"}}),
-      m_levelColors({{LogLevel::TRACE, Qt::gray},
-                     {LogLevel::DEBUG, Qt::blue},
-                     {LogLevel::INFO, Qt::darkGreen},
-                     {LogLevel::WARNING, Qt::darkYellow},
-                     {LogLevel::ERROR, Qt::red},
-                     {LogLevel::CRITICAL, Qt::darkRed}}),
-      m_levelChoiceGroup(new QButtonGroup(this)),
-      m_classChoiceGroup(new QButtonGroup(this)) {
-    m_levelChoiceGroup->setExclusive(false);
-    m_classChoiceGroup->setExclusive(false);
-
-    auto allLevelButton = new QCheckBox("All", m_parent);
-    m_levelChoiceGroup->addButton(allLevelButton);
-    m_levelChoiceGroup->setId(allLevelButton, 0);
-
-    auto allClassButton = new QCheckBox("All", m_parent);
-    m_classChoiceGroup->addButton(allClassButton);
-    m_classChoiceGroup->setId(allClassButton, 0);
-
-    connect(this, &LogTextProcessor::logTextLoaded, this,
-            &LogTextProcessor::setLogText);
-}
-
-LogTextProcessor::~LogTextProcessor() {
-    for (const auto &[levelEnum, checkBox] : m_levelCheckBoxes) {
-        delete checkBox;
-    }
-    for (const auto &[className, checkBox] : m_classCheckBoxes) {
-        delete checkBox;
-    }
-    delete m_levelChoiceGroup;
-    delete m_classChoiceGroup;
-}
-
-void LogTextProcessor::setLogText(const QString &logTextHtml) {
-    m_logTextHtml = logTextHtml;
-    m_logTextHtmlBackup = logTextHtml;
-    // updateSideBarFiltersFromFile();
-    // updateLogViewFromFile();
+      m_generation(0),
+      m_loadedBytes(0),
+      m_indexFileBytes(0),
+      m_loading(false),
+      m_follow(false),
+      m_watcher(nullptr),
+      m_followTimer(nullptr),
+      m_levelCounts(),
+      m_searchIndex(true),
+      m_timeRange(false),
+      m_timeFrom(0),
+      m_timeTo(0),
+      m_foldRepeats(false),
+      m_keptLevels(0),
+      m_foundLevels(0),
+      m_foundClasses(0),
+      m_parser(m_threadPool),
+      m_search(m_threadPool) {
+    connect(this, &LogTextProcessor::logFileLoaded, this,
+            &LogTextProcessor::setLogFile);
+    connect(this, &LogTextProcessor::levelFilterChanged, this,
+            &LogTextProcessor::setLevelFilter);
+    connect(this, &LogTextProcessor::allLevelsFilterChanged, this,
+            &LogTextProcessor::setAllLevelsFilter);
+    connect(this, &LogTextProcessor::classFilterChanged, this,
+            &LogTextProcessor::setClassFilter);
+    connect(this, &LogTextProcessor::allClassesFilterChanged, this,
+            &LogTextProcessor::setAllClassesFilter);
+    connect(this, &LogTextProcessor::templateFilterChanged, this,
+            &LogTextProcessor::setTemplateFilter);
+    connect(this, &LogTextProcessor::allTemplatesFilterChanged, this,
+            &LogTextProcessor::setAllTemplatesFilter);
+    connect(this, &LogTextProcessor::followModeChanged, this,
+            &LogTextProcessor::setFollowMode);
+    connect(this, &LogTextProcessor::searchChanged, this,
+            &LogTextProcessor::setSearch);
+    connect(this, &LogTextProcessor::searchIndexChanged, this,
+            &LogTextProcessor::setSearchIndex);
+    connect(this, &LogTextProcessor::timeRangeChanged, this,
+            &LogTextProcessor::setTimeRange);
+    connect(this, &LogTextProcessor::foldRepeatsChanged, this,
+            &LogTextProcessor::setFoldRepeats);
+    connect(this, &LogTextProcessor::repeatRunExpanded, this,
+            &LogTextProcessor::setRepeatExpanded);
 }
 
-void LogTextProcessor::updateLevelFilterFromFile() {
-    Logger::debug("Level checkboxes updating");
-    int countEnabled = 0;
-    for (const auto &level : m_levelsFromLog) {
-        Logger::debug("Level from log: {}", level.toStdString());
-    }
-    for (const auto &[levelEnum, levelString] : m_levels) {
-        auto checkBox = m_levelCheckBoxes[levelEnum];
-        if (auto search = m_levelsFromLog.find(levelString);
-            search != m_levelsFromLog.end()) {
-            checkBox->setEnabled(true);
-            checkBox->setChecked(true);
-            countEnabled++;
-            Logger::debug("Level checkbox enabled: {}",
-                          levelString.toStdString());
+LogTextProcessor::~LogTextProcessor() {}
 
-        } else {
-            checkBox->setEnabled(false);
-            checkBox->setChecked(false);
-            Logger::trace("Level checkbox disabled: {}",
-                          levelString.toStdString());
+void LogTextProcessor::setLogFile(std::shared_ptr<const LogFile> logFile) {
+    m_source = logFile;
+    m_keptLevels = 0;  // a file of its own
+    m_keptClasses.clear();
+    m_keptTemplates.clear();
+    startLoading(logFile);
+    watchFile();
+}
+
+void LogTextProcessor::setFollowMode(bool follow) {
+    if (follow == m_follow) {
+        return;
+    }
+    Logger::info("Follow mode: {}", follow);
+    m_follow = follow;
+    if (m_watcher == nullptr) {
+        m_watcher = new QFileSystemWatcher(this);
+        m_followTimer = new QTimer(this);
+        m_followTimer->setSingleShot(true);
+        m_followTimer->setInterval(FollowDelayMs);
+        auto fileChanged = [this] {
+            if (!m_followTimer->isActive()) {
+                m_followTimer->start();
+            }
+        };
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this,
+                fileChanged);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this,
+                fileChanged);
+        connect(m_followTimer, &QTimer::timeout, this,
+                &LogTextProcessor::checkFileGrowth);
+    }
+    watchFile();
+    if (m_logFile == nullptr || m_loading || m_decompressor != nullptr) {
+        return;  // the last chunk sees the new mode, archives do not grow
+    }
+    if (follow && m_lineIndex.endsWithPartialLine()) {
+        // the last line was indexed as complete but may still grow
+        reopenLastLine();
+        checkFileGrowth();
+    } else if (follow) {
+        checkFileGrowth();
+    } else if (m_lineIndex.indexedSize() < m_loadedBytes) {
+        // nothing more will be appended, index the unfinished line
+        auto text = m_logFile->text(m_lineIndex.indexedSize(), m_loadedBytes);
+        m_parser.parse(text, true, m_lineIndex, m_logTable, m_levelCounts);
+        indexSearchText(text);
+        publishDocument(text, true);
+    }
+}
+
+void LogTextProcessor::startLoading(std::shared_ptr<const LogFile> logFile) {
+    m_logFile = logFile;
+    m_decompressor.reset();
+    m_generation++;
+    m_loadedBytes = 0;
+    m_indexFileBytes = 0;
+    m_loading = false;
+    m_lineIndex.clear();
+    m_logTable.clear();
+    m_levelCounts.fill(0);
+    m_trigramIndex.clear();
+    m_timeIndex.clear();
+    m_document.reset();
+    m_logFilter.reset();
+    m_foundLevels = 0;
+    m_foundClasses = 0;
+    m_repeatFolder.reset();
+    m_templateMiner.clear();
+    m_search.reset();
+    if (m_search.isActive()) {
+        m_logFilter.setLineMatches(&m_search.matches());
+    }
+    if (m_timeRange) {
+        m_logFilter.setTimeRange(&m_timeIndex, m_timeFrom, m_timeTo);
+    }
+    updateLevelFilterFromFile();  // empties the side bar
+    updateClassFilterFromFile();
+    updateTemplatesFromFile();
+    if (m_logFile == nullptr) {
+        return;
+    }
+    if (m_follow && m_logFile->access() == LogFile::Access::Mapped) {
+        // a followed log may be truncated under a mapping
+        auto logFile = std::make_shared<LogFile>(m_logFile->fileName(),
+                                                 LogFile::Access::Read);
+        if (logFile->open()) {
+            m_logFile = logFile;
         }
     }
-    if (countEnabled == m_levelsFromLog.size()) {
-        m_levelChoiceGroup->button(0)->setChecked(true);
+    Logger::debug("Log file loading: {} bytes", m_logFile->size());
+    if (LogDecompressor::formatOf(*m_logFile) !=
+        LogDecompressor::Format::None) {
+        m_decompressor = std::make_shared<LogDecompressor>(m_logFile);
+        m_logFile = std::make_shared<const LogFile>(m_logFile->fileName(),
+                                                    m_decompressor);
+    } else {
+        // parsing goes on behind what the sidecar restored
+        m_indexFileBytes = IndexFile(m_logFile->fileName())
+                               .load(*m_logFile, m_lineIndex, m_logTable,
+                                     m_levelCounts,
+                                     m_searchIndex ? &m_trigramIndex : nullptr,
+                                     m_templateMiner);
+        m_loadedBytes = m_indexFileBytes;
     }
-    Logger::trace("Level checkboxes updated");
+    m_loading = true;
+    scheduleNextChunk();
 }
 
-void LogTextProcessor::updateClassFilterFromFile() {
-    Logger::debug("Class checkboxes updating");
-    // remove all existing class checkboxes
-    for (const auto &className : m_classes) {
-        auto button = m_classCheckBoxes[className];
-        m_classChoiceGroup->removeButton(button);
-        delete button;
-    }
-    m_classCheckBoxes.clear();
-    m_classes.clear();
-    Logger::trace("Class checkboxes removed");
-
-    m_classes = m_classesFromLog;
-    for (const auto &className : m_classes) {
-        auto button = new QCheckBox(className, m_parent);
-        m_classChoiceGroup->addButton(button);
-        button->setEnabled(true);
-        button->setChecked(true);
-        m_classCheckBoxes[className] = button;
-        Logger::trace("Class checkbox created: {}", className.toStdString());
-    }
-    m_classChoiceGroup->button(0)->setChecked(true);  // default set class all
-    Logger::trace("Class checkboxes updated");
+void LogTextProcessor::setLevelFilter(LogLevel level, bool checked) {
+    m_logFilter.setLevelChecked(level, checked);
+    filterLogText();
 }
 
-void LogTextProcessor::filterLogText(QString &logTextHtml) {
-    Logger::debug("Log text filtering");
-    filterLogText(logTextHtml, m_classes, m_levelsFromLog);
+void LogTextProcessor::setAllLevelsFilter(bool checked) {
+    m_logFilter.setAllLevelsChecked(checked);
+    filterLogText();
+}
 
-    Logger::debug("Log text filtered");
+void LogTextProcessor::setClassFilter(std::uint32_t classId, bool checked) {
+    m_logFilter.setClassChecked(classId, checked);
+    filterLogText();
 }
 
-void LogTextProcessor::filterLogText(QString &logTextHtml,
-                                     const std::set<QString> &classes,
-                                     const std::set<QString> &levels) {
-    auto levelRegex = QRegularExpression(m_levelReg);
-    bool previousLineMatched = false;
-    QString emptyHtml;
-    for (auto line : logTextHtml.split("\n")) {
-        if (line.isEmpty()) {
-            continue;
-        }
-        auto match = levelRegex.match(line);
-        if (match.hasMatch()) {
-            auto level = match.captured(1);
+void LogTextProcessor::setAllClassesFilter(bool checked) {
+    m_logFilter.setAllClassesChecked(checked);
+    filterLogText();
+}
 
-            if (levels.find(level) == levels.end()) {
-                Logger::trace("Level not matched: {}", level.toStdString());
-                continue;
-            }
+void LogTextProcessor::setTemplateFilter(quint32 templateId, bool checked) {
+    m_logFilter.setTemplateChecked(templateId, checked);
+    filterLogText();
+}
 
-            LogLevel levelEnum;
-            if (!getLogLevelFromString(level, levelEnum)) {
-                Logger::error("Unknown log level: {}", level.toStdString());
-                continue;
-            }
+void LogTextProcessor::setAllTemplatesFilter(bool checked) {
+    m_logFilter.setAllTemplatesChecked(checked);
+    filterLogText();
+}
 
-            auto checkBox = m_levelCheckBoxes[levelEnum];
-            if (checkBox->isChecked()) {
-                previousLineMatched = true;
-                emptyHtml.append(line);
-                Logger::trace("Append line: {}", line.toStdString());
-            } else {
-                previousLineMatched = false;
-            }
+void LogTextProcessor::setSearch(const QString &text, bool matchCase,
+                                 bool isRegex) {
+    m_search.setQuery(text.toStdString(), matchCase, isRegex);
+    if (!m_search.isActive()) {
+        m_logFilter.setLineMatches(nullptr);
+        filterLogText();
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (m_logFile != nullptr) {
+        m_search.update(*m_logFile, LogText(), m_lineIndex, m_trigramIndex);
+    }
+    m_logFilter.setLineMatches(&m_search.matches());
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start);
+    Logger::debug("Log text searched: {:.1f} ms", elapsed.count());
+    filterLogText();
+}
+
+void LogTextProcessor::setSearchIndex(bool enabled) {
+    if (enabled == m_searchIndex) {
+        return;
+    }
+    Logger::info("Search index: {}", enabled);
+    m_searchIndex = enabled;
+    if (enabled) {
+        indexSearchText(LogText());  // catches up with the loaded lines
+    } else {
+        m_trigramIndex = TrigramIndex();  // releases the memory
+    }
+}
+
+void LogTextProcessor::setTimeRange(bool enabled, qint64 from, qint64 to) {
+    Logger::info("Time range: {} [{}, {}]", enabled, from, to);
+    m_timeRange = enabled;
+    m_timeFrom = from;
+    m_timeTo = to;
+    m_logFilter.setTimeRange(enabled ? &m_timeIndex : nullptr, from, to);
+    filterLogText();
+}
+
+void LogTextProcessor::setFoldRepeats(bool fold) {
+    if (fold == m_foldRepeats) {
+        return;
+    }
+    Logger::info("Fold repeats: {}", fold);
+    m_foldRepeats = fold;
+    filterLogText();
+}
+
+void LogTextProcessor::setRepeatExpanded(quint32 line, bool expanded) {
+    m_repeatFolder.setExpanded(line, expanded);
+    filterLogText();
+}
+
+void LogTextProcessor::scheduleNextChunk() {
+    auto generation = m_generation;
+    QMetaObject::invokeMethod(
+        this, [this, generation] { loadNextChunk(generation); },
+        Qt::QueuedConnection);
+}
+
+void LogTextProcessor::loadNextChunk(std::uint64_t generation) {
+    if (generation != m_generation || m_logFile == nullptr) {
+        return;  // a newer file replaced this one
+    }
+    auto chunkBytes = m_loadedBytes == 0
+                          ? FirstChunkBytes
+                          : ChunkBytesPerThread * m_threadPool.threadCount();
+    if (m_decompressor != nullptr) {
+        // what the parser has not consumed stays in memory
+        m_decompressor->decompress(m_lineIndex.indexedSize(), chunkBytes);
+    }
+    const auto size = static_cast<std::uint64_t>(m_logFile->size());
+    auto end = std::min(size, m_loadedBytes + chunkBytes);
+    auto complete = end == size &&
+                    (m_decompressor == nullptr || m_decompressor->atEnd());
+    auto publishedLines = m_lineIndex.lineCount();
+    auto text = m_logFile->text(m_lineIndex.indexedSize(), end);
+    if (m_logFile->isTruncated()) {
+        Logger::info("Log file truncated while loading, loading it again");
+        loadAgain();
+        return;
+    }
+    // a followed file may still complete its last line, archives do not
+    // grow
+    m_parser.parse(text, complete && (!m_follow || m_decompressor != nullptr),
+                   m_lineIndex, m_logTable, m_levelCounts);
+    indexSearchText(text);
+    m_loadedBytes = end;
+    // compressed logs count the compressed bytes
+    if (m_decompressor != nullptr) {
+        emit logLoadingProgress(
+            static_cast<qint64>(m_decompressor->consumedBytes()),
+            m_source->size());
+    } else {
+        emit logLoadingProgress(static_cast<qint64>(end),
+                                static_cast<qint64>(size));
+    }
+
+    if (complete || m_lineIndex.lineCount() != publishedLines) {
+        publishDocument(text, complete);
+    }
+    if (!complete) {
+        scheduleNextChunk();
+        return;
+    }
+    m_loading = false;
+    saveIndexFile();
+    Logger::debug("Log file loaded: {} lines, {} classes",
+                  m_document->lineCount(), m_document->table().classes.size());
+    HOT_PATH_REPORT();
+    if (m_follow) {  // catch up with what was written meanwhile
+        checkFileGrowth();
+    }
+}
+
+void LogTextProcessor::publishDocument(const LogText &loaded, bool complete) {
+    // matches of the new lines are needed before the filter shows them
+    m_search.update(*m_logFile, loaded, m_lineIndex, m_trigramIndex);
+    m_timeIndex.index(m_logTable);
+    m_templateMiner.index(loaded, m_logTable);
+    m_logFilter.index(m_logTable);
+    restoreFilter();
+    if (m_foldRepeats) {
+        indexRepeats(loaded);
+        m_repeatFolder.extend(m_logFilter.visibleLines(), m_logTable);
+    }
+    // the copies share the columns, loading keeps appending behind them
+    m_document = std::make_shared<const LogDocument>(
+        m_source, m_logFile, m_generation, m_lineIndex, m_logTable,
+        m_timeIndex, complete);
+    updateLevelFilterFromFile();
+    updateClassFilterFromFile();
+    updateTemplatesFromFile();
+    emit logDocumentLoaded(m_document, shownLines(), shownRuns());
+}
+
+void LogTextProcessor::saveIndexFile() {
+    // a line without ending may still grow, the sidecar never has one.
+    // Compressed logs have to be decompressed again anyway
+    const auto indexedSize = m_lineIndex.indexedSize();
+    if (m_decompressor != nullptr ||
+        indexedSize < m_indexFileBytes + MinIndexFileBytes ||
+        m_lineIndex.endsWithPartialLine()) {
+        return;
+    }
+    IndexFile indexFile(m_logFile->fileName());
+    if (indexFile.save(*m_logFile, m_lineIndex, m_logTable, m_levelCounts,
+                       m_searchIndex ? &m_trigramIndex : nullptr,
+                       m_templateMiner)) {
+        m_indexFileBytes = indexedSize;
+    }
+}
+
+void LogTextProcessor::indexSearchText(const LogText &loaded) {
+    if (!m_searchIndex) {
+        return;
+    }
+    while (m_trigramIndex.lineCount() < m_lineIndex.lineCount()) {
+        m_trigramIndex.index(linesFrom(m_trigramIndex.lineCount(), loaded),
+                             m_lineIndex, m_threadPool);
+    }
+}
+
+void LogTextProcessor::indexRepeats(const LogText &loaded) {
+    while (m_repeatFolder.indexedRecords() < m_logTable.recordCount()) {
+        auto line = m_logTable.recordBegin(m_repeatFolder.indexedRecords());
+        m_repeatFolder.index(linesFrom(line, loaded), m_logTable);
+    }
+}
+
+LogText LogTextProcessor::linesFrom(std::uint64_t line,
+                                    const LogText &loaded) const {
+    const auto begin = m_lineIndex.lineBegin(line);
+    if (loaded.contains(begin, m_lineIndex.lineEnd(line))) {
+        return loaded;
+    }
+    auto last = std::max(m_lineIndex.linesBefore(begin + SliceBytes), line + 1);
+    return m_logFile->text(begin, m_lineIndex.lineEnd(last - 1));
+}
+
+void LogTextProcessor::watchFile() {
+    if (m_watcher == nullptr) {
+        return;
+    }
+    auto paths = m_watcher->files() + m_watcher->directories();
+    if (!paths.isEmpty()) {
+        m_watcher->removePaths(paths);
+    }
+    if (!m_follow || m_source == nullptr) {
+        return;
+    }
+    // the directory tells when a rotated file is created again
+    QFileInfo info(m_source->fileName());
+    m_watcher->addPath(info.absolutePath());
+    m_watcher->addPath(info.absoluteFilePath());
+}
+
+void LogTextProcessor::reopenLastLine() {
+    const auto line = m_lineIndex.lineCount() - 1;
+    const auto record = m_logTable.recordOf(line);
+    const auto records =
+        m_logTable.recordBegin(record) == line ? record : record + 1;
+    LevelCounts dropped{};
+    m_logTable.countLevels(line, dropped);
+    for (std::size_t level = 0; level < LogLevelCount; level++) {
+        m_levelCounts[level] -= dropped[level];
+    }
+    m_templateMiner.forget(m_logTable, records);
+    m_repeatFolder.truncate(records);
+    m_logTable.truncate(line);
+    m_lineIndex.truncate(line);
+    m_trigramIndex.truncate(line);
+    m_search.truncate(line);
+    m_logFilter.truncate(m_logTable);
+    m_loadedBytes = m_lineIndex.indexedSize();
+    // the line is gone until it ends, the ui drops what it showed of it
+    publishDocument(LogText(), true);
+}
+
+void LogTextProcessor::checkFileGrowth() {
+    if (!m_follow || m_logFile == nullptr || m_loading ||
+        m_decompressor != nullptr) {
+        return;
+    }
+    QFileInfo info(m_source->fileName());
+    if (!info.exists()) {
+        return;  // rotated away, wait for the file to be created again
+    }
+    if (!m_watcher->files().contains(info.absoluteFilePath())) {
+        m_watcher->addPath(info.absoluteFilePath());  // dropped on rename
+    }
+    // a mapped log is read from now on, it may be truncated under the
+    // mapping
+    const bool mapped = m_logFile->access() == LogFile::Access::Mapped;
+    if (info.size() == m_logFile->size() && !mapped) {
+        return;
+    }
+    auto logFile = std::make_shared<LogFile>(m_source->fileName(),
+                                             LogFile::Access::Read);
+    if (!logFile->open()) {
+        return;
+    }
+    auto head = std::min<std::uint64_t>(m_logFile->size(), HeadBytes);
+    if (logFile->size() < m_logFile->size() || m_logFile->isTruncated() ||
+        logFile->text(0, head).view(0, head) !=
+            m_logFile->text(0, head).view(0, head)) {
+        Logger::info("Log file truncated or replaced, loading it again");
+        keepFilter();
+        startLoading(logFile);
+        return;
+    }
+    m_logFile = logFile;
+    if (static_cast<std::uint64_t>(logFile->size()) == m_loadedBytes) {
+        if (m_document != nullptr) {  // nothing new, drops the mapping
+            publishDocument(LogText(), m_document->isComplete());
+        }
+        return;
+    }
+    m_loading = true;
+    scheduleNextChunk();
+}
+
+void LogTextProcessor::loadAgain() {
+    auto logFile = std::make_shared<LogFile>(m_source->fileName(),
+                                             LogFile::Access::Read);
+    if (logFile->open()) {
+        keepFilter();
+        startLoading(logFile);
+    } else {
+        m_loading = false;  // following tries again on the next change
+    }
+}
+
+void LogTextProcessor::keepFilter() {
+    // what the user checked again replaces what an earlier load kept
+    for (std::size_t level = 0; level < LogLevelCount; level++) {
+        if (m_levelCounts[level] == 0) {
+            continue;
+        }
+        if (m_logFilter.isLevelChecked(static_cast<std::uint8_t>(level))) {
+            m_keptLevels &= static_cast<std::uint8_t>(~(1u << level));
         } else {
-            if (previousLineMatched) {
-                emptyHtml.append(line);
-                Logger::trace("Append line: {}", line.toStdString());
-            }
+            m_keptLevels |= static_cast<std::uint8_t>(1u << level);
         }
     }
-    logTextHtml = emptyHtml;
-
-    // class
-}
-
-void LogTextProcessor::showLevelInDifferentColor(QString &logTextHtml) {
-    Logger::debug("Showing level in different color");
-    auto levelClassRegex = QRegularExpression(QString("%1").arg(m_levelReg));
-    auto matches = levelClassRegex.globalMatch(logTextHtml);
-    std::vector<QRegularExpressionMatch> revertedMatches;
-
-    while (matches.hasNext()) {
-        auto match = matches.next();
-        revertedMatches.push_back(match);
-    }
-    for (int i = revertedMatches.size() - 1; i >= 0; i--) {
-        auto match = revertedMatches[i];
-        auto level = match.captured(1);
-        for (const auto &[levelEnum, levelString] : m_levels) {
-            if (levelString.toLower() == level.toLower()) {
-                auto color = m_levelColors[levelEnum].name();
-                auto original = match.capturedTexts().at(0);
-                auto replace = QString("<span style=\"color: %1;\">%2</span>")
-                                   .arg(color)
-                                   .arg(original);
-                logTextHtml.replace(match.capturedStart(),
-                                    match.capturedLength(), replace);
-                Logger::trace("match: {}, replace: {}", original.toStdString(),
-                              replace.toStdString());
-            }
+    const auto &classes = m_logTable.classes;
+    for (std::uint32_t id = 0; id < classes.size(); id++) {
+        std::string name(classes.name(id));
+        if (m_logFilter.isClassChecked(id)) {
+            m_keptClasses.erase(name);
+        } else {
+            m_keptClasses.insert(std::move(name));
         }
     }
-    Logger::debug("Showed level in different color");
-}
-
- //void LogTextProcessor::updateSideBarFiltersFromFile() {
- //    QRegularExpression levelClassRegex(m_levelReg + m_classReg);
- //    m_levelsFromLog.clear();
- //    m_classesFromLog.clear();
-
- //    auto text = m_logText->toPlainText();
- //    auto matches = levelClassRegex.globalMatch(text);
- //    while (matches.hasNext()) {
- //        auto match = matches.next();
- //        auto level = match.captured(1);
- //        auto className = match.captured(2);
- //        m_levelsFromLog.insert(capitalize(level.toLower()));
- //        m_classesFromLog.insert(className.toLower());
- //        Logger::trace("Level: {}, Class: {}", level.toStdString(),
- //                      className.toStdString());
- //    }
- //    updateLevelFilterFromFile();
- //    updateClassFilterFromFile();
- //    Logger::debug("Update sidebar filters");
- //}
+    for (std::uint32_t id = 0; id < m_templateMiner.size(); id++) {
+        auto text = templateText(id);
+        if (m_logFilter.isTemplateChecked(id)) {
+            m_keptTemplates.erase(text);
+        } else {
+            m_keptTemplates.insert(std::move(text));
+        }
+    }
+}
 
-QString LogTextProcessor::capitalize(const QString &str) {
-    return str.at(0).toUpper() + str.mid(1);
+void LogTextProcessor::restoreFilter() {
+    for (std::size_t level = 0; level < LogLevelCount; level++) {
+        const auto bit = static_cast<std::uint8_t>(1u << level);
+        if (m_levelCounts[level] == 0 || (m_foundLevels & bit) != 0) {
+            continue;
+        }
+        // also after "All" was unchecked
+        m_foundLevels |= bit;
+        m_logFilter.setLevelChecked(static_cast<LogLevel>(level),
+                                    (m_keptLevels & bit) == 0);
+        m_keptLevels &= static_cast<std::uint8_t>(~bit);
+    }
+    const auto &classes = m_logTable.classes;
+    for (; m_foundClasses < classes.size(); m_foundClasses++) {
+        auto kept =
+            m_keptClasses.find(std::string(classes.name(m_foundClasses)));
+        if (kept != m_keptClasses.end()) {
+            m_logFilter.setClassChecked(m_foundClasses, false);
+            m_keptClasses.erase(kept);
+        }
+    }
+    // a template may only match once enough records widened it
+    for (std::uint32_t id = 0;
+         id < m_templateMiner.size() && !m_keptTemplates.empty(); id++) {
+        auto kept = m_keptTemplates.find(templateText(id));
+        if (kept != m_keptTemplates.end()) {
+            m_logFilter.setTemplateChecked(id, false);
+            m_keptTemplates.erase(kept);
+        }
+    }
+}
+
+void LogTextProcessor::updateLevelFilterFromFile() {
+    Logger::debug("Level checkboxes updating");
+    std::vector<LogLevel> levelsFromLog;
+    for (std::size_t level = 0; level < LogLevelCount; level++) {
+        if (m_levelCounts[level] != 0) {
+            levelsFromLog.push_back(static_cast<LogLevel>(level));
+            Logger::debug("Level from log: {}", LogLevelNames[level]);
+        }
+    }
+    emit updateLevelCheckBoxes(levelsFromLog, m_logFilter.levelMask());
+    Logger::trace("Level checkboxes updated");
 }
 
-bool LogTextProcessor::getLogLevelFromString(const QString &level,
-                                             LogLevel &logLevel) {
-    for (const auto &[levelEnum, levelString] : m_levels) {
-        if (levelString.toLower() == level.toLower()) {
-            logLevel = levelEnum;
-            return true;
+void LogTextProcessor::updateClassFilterFromFile() {
+    Logger::debug("Class checkboxes updating");
+    std::vector<QString> classNames;
+    std::vector<bool> checked;
+    if (m_document != nullptr) {
+        const auto &classes = m_document->table().classes;
+        classNames.reserve(classes.size());
+        checked.reserve(classes.size());
+        for (std::uint32_t id = 0; id < classes.size(); id++) {
+            auto name = classes.name(id);
+            classNames.push_back(QString::fromUtf8(name.data(), name.size()));
+            checked.push_back(m_logFilter.isClassChecked(id));
         }
     }
-    return false;
-}
\ No newline at end of file
+    emit updateClassCheckBoxes(classNames, checked);
+    Logger::trace("Class checkboxes updated");
+}
+
+void LogTextProcessor::updateTemplatesFromFile() {
+    std::vector<TemplateSummary> templates;
+    templates.reserve(m_templateMiner.size());
+    for (std::uint32_t id = 0; id < m_templateMiner.size(); id++) {
+        const auto &minedTemplate = m_templateMiner.at(id);
+        templates.push_back({templateText(id), minedTemplate.count,
+                             minedTemplate.first, minedTemplate.last,
+                             m_logFilter.isTemplateChecked(id)});
+    }
+    emit updateTemplates(templates);
+    Logger::trace("Templates updated: {}", templates.size());
+}
+
+QString LogTextProcessor::templateText(std::uint32_t id) const {
+    const auto &minedTemplate = m_templateMiner.at(id);
+    auto text = QString::fromStdString(m_templateMiner.text(id));
+    if (minedTemplate.classId != LogTable::NoClass) {
+        auto name = m_logTable.classes.name(minedTemplate.classId);
+        text = QString::fromUtf8(name.data(), name.size()) + " -- " + text;
+    }
+    return text;
+}
+
+void LogTextProcessor::filterLogText() {
+    if (m_document == nullptr) {
+        return;
+    }
+    if (m_foldRepeats) {
+        indexRepeats(LogText());
+        m_repeatFolder.fold(m_logFilter.visibleLines(), m_logTable);
+    }
+    // the filter already applied the change, only publish a snapshot of the
+    // bitmap, the document is shared as is
+    auto lines = shownLines();
+    emit logLinesFiltered(m_document, lines, shownRuns());
+    Logger::debug("Log text filtered: {} lines", lines->size());
+}
+
+std::shared_ptr<const VisibleLines> LogTextProcessor::shownLines() const {
+    return std::make_shared<const VisibleLines>(
+        m_foldRepeats ? m_repeatFolder.visibleLines()
+                      : m_logFilter.visibleLines());
+}
+
+std::shared_ptr<const RepeatRuns> LogTextProcessor::shownRuns() const {
+    if (!m_foldRepeats) {
+        return nullptr;
+    }
+    return std::make_shared<const RepeatRuns>(m_repeatFolder.runs());
+}
+
+QString LogTextProcessor::capitalize(const QString &str) {
+    return str.at(0).toUpper() + str.mid(1);
+}
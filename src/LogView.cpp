@@ -0,0 +1,295 @@
+#include <HotPath.h>
+#include <LogView.h>
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QStyledItemDelegate>
+#include <QTimer>
+#include <algorithm>
+
+LogView::LogView(QWidget *parent)
+    : QAbstractScrollArea(parent),
+      m_model(nullptr),
+      m_delegate(new QStyledItemDelegate(this)),
+      m_currentRow(-1),
+      m_selectionAnchor(-1),
+      m_maxRowWidth(0) {
+    setFocusPolicy(Qt::StrongFocus);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+}
+
+void LogView::setModel(QAbstractItemModel *model) {
+    if (m_model != nullptr) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+    m_model = model;
+    if (m_model != nullptr) {
+        connect(m_model, &QAbstractItemModel::modelReset, this,
+                &LogView::resetView);
+        connect(m_model, &QAbstractItemModel::layoutAboutToBeChanged, this,
+                &LogView::saveRows);
+        connect(m_model, &QAbstractItemModel::layoutChanged, this,
+                &LogView::restoreRows);
+        connect(m_model, &QAbstractItemModel::rowsInserted, this,
+                &LogView::updateScrollBars);
+        connect(m_model, &QAbstractItemModel::rowsRemoved, this,
+                &LogView::updateScrollBars);
+        connect(m_model, &QAbstractItemModel::dataChanged, viewport(),
+                qOverload<>(&QWidget::update));
+    }
+    resetView();
+}
+
+void LogView::setItemDelegate(QAbstractItemDelegate *delegate) {
+    if (m_delegate != nullptr && m_delegate->parent() == this) {
+        delete m_delegate;
+    }
+    m_delegate = delegate;
+    viewport()->update();
+}
+
+void LogView::setCurrentRow(int row) {
+    if (m_model == nullptr || m_model->rowCount() == 0) {
+        return;
+    }
+    m_currentRow = std::clamp(row, 0, m_model->rowCount() - 1);
+    m_selectionAnchor = m_currentRow;
+    scrollToRow(m_currentRow);
+    viewport()->update();
+}
+
+void LogView::scrollToRow(int row) {
+    auto first = verticalScrollBar()->value();
+    auto visible = std::max(1, visibleRowCount() - 1);
+    if (row < first) {
+        verticalScrollBar()->setValue(row);
+    } else if (row >= first + visible) {
+        verticalScrollBar()->setValue(row - visible + 1);
+    }
+}
+
+void LogView::scrollToBottom() {
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+void LogView::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+    if (m_model == nullptr || m_delegate == nullptr) {
+        return;
+    }
+    HOT_PATH_SCOPE("LogView::paintEvent");
+    QPainter painter(viewport());
+    auto height = rowHeight();
+    auto offsetX = horizontalScrollBar()->value();
+    auto first = verticalScrollBar()->value();
+    auto last = std::min(m_model->rowCount(), first + visibleRowCount() + 1);
+
+    QStyleOptionViewItem option;
+    option.initFrom(this);
+    option.widget = this;
+    option.font = font();
+    option.displayAlignment = Qt::AlignLeft | Qt::AlignVCenter;
+    option.textElideMode = Qt::ElideNone;
+    option.features = QStyleOptionViewItem::HasDisplay;
+
+    HOT_PATH_SAMPLE("LogView::paintedRows", last - first);
+    auto widest = m_maxRowWidth;
+    for (int row = first; row < last; row++) {
+        auto index = m_model->index(row, 0);
+        option.state = QStyle::State_Enabled;
+        if (hasFocus()) {
+            option.state |= QStyle::State_Active;
+        }
+        if (isRowSelected(row)) {
+            option.state |= QStyle::State_Selected;
+        }
+        auto rowWidth = m_delegate->sizeHint(option, index).width();
+        widest = std::max(widest, rowWidth);
+        option.rect =
+            QRect(-offsetX, (row - first) * height,
+                  std::max(rowWidth, viewport()->width() + offsetX), height);
+        m_delegate->paint(&painter, option, index);
+    }
+    if (widest != m_maxRowWidth) {
+        m_maxRowWidth = widest;
+        QTimer::singleShot(0, this, &LogView::updateScrollBars);
+    }
+}
+
+void LogView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LogView::scrollContentsBy(int dx, int dy) {
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+}
+
+void LogView::mousePressEvent(QMouseEvent *event) {
+    auto row = rowAt(event->position().toPoint().y());
+    if (row < 0 || event->button() != Qt::LeftButton) {
+        return;
+    }
+    m_currentRow = row;
+    if (!(event->modifiers() & Qt::ShiftModifier) || m_selectionAnchor < 0) {
+        m_selectionAnchor = row;
+    }
+    viewport()->update();
+}
+
+void LogView::mouseMoveEvent(QMouseEvent *event) {
+    if (!(event->buttons() & Qt::LeftButton) || m_selectionAnchor < 0) {
+        return;
+    }
+    auto row = rowAt(event->position().toPoint().y());
+    if (row >= 0) {
+        m_currentRow = row;
+        scrollToRow(row);
+        viewport()->update();
+    }
+}
+
+void LogView::mouseDoubleClickEvent(QMouseEvent *event) {
+    auto row = rowAt(event->position().toPoint().y());
+    if (row >= 0 && event->button() == Qt::LeftButton) {
+        emit rowActivated(row);
+    }
+}
+
+void LogView::keyPressEvent(QKeyEvent *event) {
+    if (m_model == nullptr) {
+        return;
+    }
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    auto page = std::max(1, visibleRowCount() - 1);
+    auto row = m_currentRow;
+    switch (event->key()) {
+        case Qt::Key_Up:
+            row--;
+            break;
+        case Qt::Key_Down:
+            row++;
+            break;
+        case Qt::Key_PageUp:
+            row -= page;
+            break;
+        case Qt::Key_PageDown:
+            row += page;
+            break;
+        case Qt::Key_Home:
+            row = 0;
+            break;
+        case Qt::Key_End:
+            row = m_model->rowCount() - 1;
+            break;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            if (m_currentRow >= 0) {
+                emit rowActivated(m_currentRow);
+            }
+            return;
+        default:
+            QAbstractScrollArea::keyPressEvent(event);
+            return;
+    }
+    auto anchor = m_selectionAnchor;
+    setCurrentRow(row);
+    if (event->modifiers() & Qt::ShiftModifier && anchor >= 0) {
+        m_selectionAnchor = anchor;
+    }
+}
+
+void LogView::updateScrollBars() {
+    auto rows = m_model == nullptr ? 0 : m_model->rowCount();
+    auto visible = visibleRowCount();
+    verticalScrollBar()->setRange(0, std::max(0, rows - visible));
+    verticalScrollBar()->setPageStep(visible);
+    verticalScrollBar()->setSingleStep(1);
+    horizontalScrollBar()->setRange(
+        0, std::max(0, m_maxRowWidth - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth());
+    viewport()->update();
+}
+
+void LogView::resetView() {
+    m_currentRow = -1;
+    m_selectionAnchor = -1;
+    m_maxRowWidth = 0;
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+}
+
+void LogView::saveRows() {
+    // the model moves persistent indices to the rows their lines get
+    auto rows = m_model->rowCount();
+    auto save = [this, rows](int row) {
+        return row >= 0 && row < rows
+                   ? QPersistentModelIndex(m_model->index(row, 0))
+                   : QPersistentModelIndex();
+    };
+    m_savedCurrent = save(m_currentRow);
+    m_savedAnchor = save(m_selectionAnchor);
+    m_savedTop = save(verticalScrollBar()->value());
+}
+
+void LogView::restoreRows() {
+    auto rowOf = [](const QPersistentModelIndex &index) {
+        return index.isValid() ? index.row() : -1;
+    };
+    m_currentRow = rowOf(m_savedCurrent);
+    m_selectionAnchor =
+        m_currentRow < 0 ? -1 : std::max(rowOf(m_savedAnchor), 0);
+    auto top = std::max(rowOf(m_savedTop), 0);
+    m_savedCurrent = QPersistentModelIndex();
+    m_savedAnchor = QPersistentModelIndex();
+    m_savedTop = QPersistentModelIndex();
+    updateScrollBars();
+    verticalScrollBar()->setValue(top);
+}
+
+int LogView::rowHeight() const { return fontMetrics().height() + 2; }
+
+int LogView::visibleRowCount() const {
+    return std::max(1, viewport()->height() / rowHeight());
+}
+
+int LogView::rowAt(int y) const {
+    if (m_model == nullptr) {
+        return -1;
+    }
+    auto row = verticalScrollBar()->value() + y / rowHeight();
+    return row < m_model->rowCount() ? row : -1;
+}
+
+bool LogView::isRowSelected(int row) const {
+    if (m_currentRow < 0 || m_selectionAnchor < 0) {
+        return false;
+    }
+    return row >= std::min(m_currentRow, m_selectionAnchor) &&
+           row <= std::max(m_currentRow, m_selectionAnchor);
+}
+
+void LogView::copySelection() {
+    if (m_currentRow < 0 || m_selectionAnchor < 0) {
+        return;
+    }
+    QStringList lines;
+    auto first = std::min(m_currentRow, m_selectionAnchor);
+    auto last = std::max(m_currentRow, m_selectionAnchor);
+    for (int row = first; row <= last; row++) {
+        lines.append(m_model->index(row, 0).data().toString());
+    }
+    QApplication::clipboard()->setText(lines.join("\n"));
+}
@@ -1,21 +1,48 @@
 
 #include "MainWindow.h"
 
+#include <HotPath.h>
+#include <LogDecompressor.h>
 #include <Logger.h>
 
+#include <QAbstractButton>
 #include <QDialog>
 #include <QFileDialog>
+#include <QFontDatabase>
 #include <QFrame>
 #include <QGuiApplication>
 #include <QHBoxLayout>
+#include <QInputDialog>
 #include <QMenuBar>
+#include <QProgressBar>
 #include <QObject>
 #include <QScreen>
 #include <QScrollArea>
+#include <QSignalBlocker>
 #include <QSplitter>
+#include <QStatusBar>
+#include <QTextEdit>
+#include <QTimeZone>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+// timestamps are the local time written in the log, kept as if it was utc
+const QString TimeFormat = "yyyy-MM-dd HH:mm:ss.zzz";
+
+QDateTime toDateTime(qint64 micros) {
+    return QDateTime::fromMSecsSinceEpoch(micros / 1000, QTimeZone::utc());
+}
+
+qint64 toMicros(const QDateTime &dateTime) {
+    return dateTime.toMSecsSinceEpoch() * 1000;
+}
+}  // namespace
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), m_logTextProcessor(new LogTextProcessor(this)) {
+    : QMainWindow(parent),
+      m_currentLog(nullptr),
+      m_logTextProcessor(new LogTextProcessor()) {
     setMainWindowSize();
     createActions();
     createMenu();
@@ -26,8 +53,14 @@ MainWindow::MainWindow(QWidget *parent)
             &MainWindow::updateLevelCheckBoxes);
     connect(m_logTextProcessor, &LogTextProcessor::updateClassCheckBoxes, this,
             &MainWindow::updateClassCheckBoxes);
-    connect(m_logTextProcessor, &LogTextProcessor::logTextProcessed, this,
-            &MainWindow::updateLogText);
+    connect(m_logTextProcessor, &LogTextProcessor::updateTemplates, this,
+            &MainWindow::updateTemplateList);
+    connect(m_logTextProcessor, &LogTextProcessor::logLinesFiltered, this,
+            &MainWindow::updateLogLines);
+    connect(m_logTextProcessor, &LogTextProcessor::logDocumentLoaded, this,
+            &MainWindow::updateLogDocument);
+    connect(m_logTextProcessor, &LogTextProcessor::logLoadingProgress, this,
+            &MainWindow::updateLoadingProgress);
 
     m_logTextProcessorThread = new QThread(this);
     m_logTextProcessor->moveToThread(m_logTextProcessorThread);
@@ -39,6 +72,7 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow() {
     m_logTextProcessorThread->quit();
     m_logTextProcessorThread->wait();
+    HOT_PATH_REPORT();
 }
 
 void MainWindow::setMainWindowSize() {
@@ -60,6 +94,12 @@ void MainWindow::createMenu() {
     auto fileMenu = menuBar()->addMenu(tr("&File"));
     fileMenu->addAction(m_openAction);
     fileMenu->addAction(m_closeAction);
+    fileMenu->addSeparator();
+    fileMenu->addAction(m_followAction);
+    fileMenu->addAction(m_findAction);
+    fileMenu->addAction(m_goToTimeAction);
+    fileMenu->addAction(m_foldRepeatsAction);
+    fileMenu->addAction(m_searchIndexAction);
     menuBar()->addAction(m_helpAction);
     menuBar()->addAction(m_aboutAction);
     Logger::debug("Menu created");
@@ -76,6 +116,21 @@ QWidget *MainWindow::createSideBar() {
         m_levelCheckBoxLayout->setAlignment(Qt::AlignTop | Qt::AlignLeft);
         auto levelChoiceTitle = new QLabel("Log Level", this);
         m_levelCheckBoxLayout->addWidget(levelChoiceTitle);
+
+        m_levelChoiceGroup = new QButtonGroup(this);
+        m_levelChoiceGroup->setExclusive(false);
+        auto allLevelButton = new QCheckBox("All", this);
+        allLevelButton->setEnabled(false);
+        m_levelChoiceGroup->addButton(allLevelButton, 0);
+        m_levelCheckBoxLayout->addWidget(allLevelButton);
+        for (std::size_t level = 0; level < LogLevelCount; level++) {
+            auto button = new QCheckBox(LogLevelNames[level], this);
+            button->setEnabled(false);
+            m_levelChoiceGroup->addButton(button, static_cast<int>(level) + 1);
+            m_levelCheckBoxLayout->addWidget(button);
+        }
+        connect(m_levelChoiceGroup, &QButtonGroup::idClicked, this,
+                &MainWindow::levelCheckBoxClicked);
         sideBarLayout->addLayout(m_levelCheckBoxLayout);
     }
     Logger::debug("Level checkboxes created");
@@ -103,6 +158,15 @@ QWidget *MainWindow::createSideBar() {
             m_classCheckBoxLayout = new QVBoxLayout(scrollWidget);
             m_classCheckBoxLayout->setAlignment(Qt::AlignTop | Qt::AlignLeft);
             scrollWidget->setLayout(m_classCheckBoxLayout);
+
+            m_classChoiceGroup = new QButtonGroup(this);
+            m_classChoiceGroup->setExclusive(false);
+            auto allClassButton = new QCheckBox("All", this);
+            allClassButton->setEnabled(false);
+            m_classChoiceGroup->addButton(allClassButton, 0);
+            m_classCheckBoxLayout->addWidget(allClassButton);
+            connect(m_classChoiceGroup, &QButtonGroup::idClicked, this,
+                    &MainWindow::classCheckBoxClicked);
         }
         classChoiceLayout->addWidget(classChoiceTitle);
         classChoiceLayout->addWidget(scrollArea);
@@ -113,6 +177,35 @@ QWidget *MainWindow::createSideBar() {
     return sideBarWidget;
 }
 
+QWidget *MainWindow::createTemplateList() {
+    Logger::debug("Template list creating");
+    auto templateWidget = new QWidget(this);
+    auto templateLayout = new QVBoxLayout(templateWidget);
+    auto templateTitle = new QLabel("Log Template", this);
+    m_allTemplatesBox = new QCheckBox("All", this);
+    m_allTemplatesBox->setChecked(true);
+    m_allTemplatesBox->setEnabled(false);
+    connect(m_allTemplatesBox, &QCheckBox::clicked, this,
+            &MainWindow::allTemplatesClicked);
+
+    // the most frequent templates first, every column sorts
+    m_templateList = new QTreeWidget(this);
+    m_templateList->setColumnCount(4);
+    m_templateList->setHeaderLabels({"Template", "Count", "First", "Last"});
+    m_templateList->setRootIsDecorated(false);
+    m_templateList->setUniformRowHeights(true);
+    m_templateList->setSortingEnabled(true);
+    m_templateList->sortByColumn(1, Qt::DescendingOrder);
+    connect(m_templateList, &QTreeWidget::itemChanged, this,
+            &MainWindow::templateItemChanged);
+
+    templateLayout->addWidget(templateTitle);
+    templateLayout->addWidget(m_allTemplatesBox);
+    templateLayout->addWidget(m_templateList);
+    Logger::debug("Template list created");
+    return templateWidget;
+}
+
 QWidget *MainWindow::createLogView() {
     Logger::debug("Log view creating");
     auto logViewWidget = new QWidget(this);
@@ -120,18 +213,103 @@ QWidget *MainWindow::createLogView() {
     m_logFileName = new QLabel("No file opened.", this);
     m_logFileName->setFrameStyle(QFrame::Box | QFrame::Plain);
     logViewLayout->addWidget(m_logFileName);
-
-    m_logText = new QTextEdit(this);
-    m_logText->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
-    logViewLayout->addWidget(m_logText);
-    m_logText->setReadOnly(true);
-    m_logText->setLineWrapMode(QTextEdit::NoWrap);
-    m_logText->setWordWrapMode(QTextOption::NoWrap);
+    logViewLayout->addWidget(createSearchBar());
+    logViewLayout->addWidget(createTimeBar());
+
+    m_logModel = new LogListModel(this);
+    m_logView = new LogView(this);
+    m_logView->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+    m_logView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_logView->setModel(m_logModel);
+    // rows are cached by line number, which only changes meaning with the
+    // file, filtering keeps the cache
+    m_logDelegate = new LogItemDelegate(m_logView);
+    m_logView->setItemDelegate(m_logDelegate);
+    m_timeline = new TimelineWidget(this);
+    connect(m_timeline, &TimelineWidget::timeClicked, this,
+            &MainWindow::showTime);
+    connect(m_logView, &LogView::rowActivated, this,
+            &MainWindow::toggleRepeatRun);
+    auto logLayout = new QHBoxLayout();
+    logLayout->addWidget(m_logView);
+    logLayout->addWidget(m_timeline);
+    logViewLayout->addLayout(logLayout);
+    // while following, new lines and filter changes show the end of the log
+    auto followTail = [this] {
+        if (m_followAction->isChecked()) {
+            m_logView->scrollToBottom();
+        }
+    };
+    connect(m_logModel, &QAbstractItemModel::rowsInserted, this, followTail);
+    connect(m_logModel, &QAbstractItemModel::modelReset, this, followTail);
+    connect(m_logModel, &QAbstractItemModel::layoutChanged, this, followTail);
 
     Logger::debug("Log view created");
     return logViewWidget;
 }
 
+QWidget *MainWindow::createSearchBar() {
+    Logger::debug("Search bar creating");
+    auto searchBarWidget = new QWidget(this);
+    auto searchBarLayout = new QHBoxLayout(searchBarWidget);
+    searchBarLayout->setContentsMargins(0, 0, 0, 0);
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(tr("Search"));
+    m_searchEdit->setClearButtonEnabled(true);
+    m_matchCaseBox = new QCheckBox(tr("Match case"), this);
+    searchBarLayout->addWidget(m_searchEdit);
+    m_regexBox = new QCheckBox(tr("Regex"), this);
+    searchBarLayout->addWidget(m_matchCaseBox);
+    searchBarLayout->addWidget(m_regexBox);
+
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(200);
+    connect(m_searchTimer, &QTimer::timeout, this,
+            &MainWindow::searchLogText);
+    connect(m_searchEdit, &QLineEdit::textChanged, m_searchTimer,
+            qOverload<>(&QTimer::start));
+    connect(m_searchEdit, &QLineEdit::returnPressed, this,
+            &MainWindow::searchLogText);
+    connect(m_matchCaseBox, &QCheckBox::toggled, this,
+            &MainWindow::searchLogText);
+    connect(m_regexBox, &QCheckBox::toggled, this,
+            &MainWindow::searchLogText);
+    Logger::debug("Search bar created");
+    return searchBarWidget;
+}
+
+QWidget *MainWindow::createTimeBar() {
+    Logger::debug("Time bar creating");
+    auto timeBarWidget = new QWidget(this);
+    auto timeBarLayout = new QHBoxLayout(timeBarWidget);
+    timeBarLayout->setContentsMargins(0, 0, 0, 0);
+    m_timeRangeBox = new QCheckBox(tr("Time range"), this);
+    timeBarLayout->addWidget(m_timeRangeBox);
+    m_timeFromEdit = new QDateTimeEdit(this);
+    m_timeToEdit = new QDateTimeEdit(this);
+    for (auto edit : {m_timeFromEdit, m_timeToEdit}) {
+        edit->setTimeSpec(Qt::UTC);
+        edit->setDisplayFormat(TimeFormat);
+        edit->setEnabled(false);
+        timeBarLayout->addWidget(edit);
+        connect(edit, &QDateTimeEdit::dateTimeChanged, this,
+                &MainWindow::filterTimeRange);
+    }
+    timeBarLayout->addStretch();
+    connect(m_timeRangeBox, &QCheckBox::toggled, this, [this](bool checked) {
+        m_timeFromEdit->setEnabled(checked);
+        m_timeToEdit->setEnabled(checked);
+        if (checked) {
+            filterTimeRange();
+        } else {
+            emit m_logTextProcessor->timeRangeChanged(false, 0, 0);
+        }
+    });
+    Logger::debug("Time bar created");
+    return timeBarWidget;
+}
+
 void MainWindow::createCentralWidget() {
     Logger::debug("Central widget creating");
     auto centralWidget = new QWidget(this);
@@ -141,9 +319,13 @@ void MainWindow::createCentralWidget() {
     splitter->setOrientation(Qt::Horizontal);
     splitter->setChildrenCollapsible(false);
     splitter->setOpaqueResize(true);
-    auto sideBarWidget = createSideBar();
+    auto sideBarSplitter = new QSplitter(this);
+    sideBarSplitter->setOrientation(Qt::Vertical);
+    sideBarSplitter->setChildrenCollapsible(false);
+    sideBarSplitter->addWidget(createSideBar());
+    sideBarSplitter->addWidget(createTemplateList());
     auto logViewWidget = createLogView();
-    splitter->addWidget(sideBarWidget);
+    splitter->addWidget(sideBarSplitter);
     splitter->addWidget(logViewWidget);
     auto sidebarSize = (int)round(width() * 0.3);
     splitter->setSizes({sidebarSize, width() - sidebarSize});
@@ -164,6 +346,12 @@ void MainWindow::createCentralWidget() {
 
 void MainWindow::createStatusBar() {
     Logger::debug("Status bar creating");
+    m_loadingProgress = new QProgressBar(this);
+    m_loadingProgress->setRange(0, 1000);
+    m_loadingProgress->setMaximumWidth(200);
+    m_loadingProgress->setTextVisible(false);
+    m_loadingProgress->hide();
+    statusBar()->addPermanentWidget(m_loadingProgress);
     Logger::debug("Status bar created");
 }
 
@@ -179,6 +367,51 @@ void MainWindow::createActions() {
     m_closeAction->setStatusTip(tr("Close the file"));
     connect(m_closeAction, &QAction::triggered, this, &MainWindow::closeFile);
 
+    m_followAction = new QAction(tr("&Follow"), this);
+    m_followAction->setCheckable(true);
+    m_followAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_T));
+    m_followAction->setStatusTip(tr("Show lines appended to the file"));
+    connect(m_followAction, &QAction::toggled, this, [this](bool checked) {
+        emit m_logTextProcessor->followModeChanged(checked);
+    });
+
+    m_findAction = new QAction(tr("&Find"), this);
+    m_findAction->setShortcuts(QKeySequence::Find);
+    m_findAction->setStatusTip(tr("Show only lines containing a text"));
+    connect(m_findAction, &QAction::triggered, this, [this] {
+        m_searchEdit->setFocus();
+        m_searchEdit->selectAll();
+    });
+
+    m_goToTimeAction = new QAction(tr("&Go to Time"), this);
+    m_goToTimeAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_G));
+    m_goToTimeAction->setStatusTip(
+        tr("Show the first line logged at or after a time"));
+    connect(m_goToTimeAction, &QAction::triggered, this,
+            &MainWindow::goToTime);
+
+    m_foldRepeatsAction = new QAction(tr("Fold &Repeats"), this);
+    m_foldRepeatsAction->setCheckable(true);
+    m_foldRepeatsAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_R));
+    m_foldRepeatsAction->setStatusTip(
+        tr("Show consecutive records that only differ in numbers as one "
+           "row, double click it to expand"));
+    connect(m_foldRepeatsAction, &QAction::toggled, this,
+            [this](bool checked) {
+                emit m_logTextProcessor->foldRepeatsChanged(checked);
+            });
+
+    m_searchIndexAction = new QAction(tr("Search &Index"), this);
+    m_searchIndexAction->setCheckable(true);
+    m_searchIndexAction->setChecked(true);
+    m_searchIndexAction->setStatusTip(
+        tr("Index the text while loading so searches only scan candidate "
+           "lines"));
+    connect(m_searchIndexAction, &QAction::toggled, this,
+            [this](bool checked) {
+                emit m_logTextProcessor->searchIndexChanged(checked);
+            });
+
     m_helpAction = new QAction(tr("&Help"), this);
     m_helpAction->setShortcuts(QKeySequence::HelpContents);
     m_helpAction->setStatusTip(tr("Show the application's help"));
@@ -215,7 +448,8 @@ void MainWindow::showHelpDialog() {
 const QString MainWindow::getHelpText() {
     auto textTitle = QString("<h1>%1</h1>").arg("Feature");
     auto openFileSubtitle = QString("<h2>%1</h2>").arg("Open file");
-    auto openFileList = std::vector<QString>{"Open a file", "Close a file"};
+    auto openFileList = std::vector<QString>{"Open a file", "Close a file",
+                                             "Follow a growing file"};
     auto openFileItems = QString("<ul>");
     for (const auto &item : openFileList) {
         openFileItems.append(QString("<li>%1</li>").arg(item));
@@ -224,7 +458,12 @@ const QString MainWindow::getHelpText() {
 
     auto filterSubtitle = QString("<h2>%1</h2>").arg("Filter");
     auto filterList =
-        std::vector<QString>{"Filter by log level", "Filter by log class"};
+        std::vector<QString>{"Filter by log level", "Filter by log class",
+                             "Search text or regular expression",
+                             "Filter by time range", "Go to a time",
+                             "Timeline of records by level",
+                             "Fold repeated records",
+                             "Filter by message template"};
     auto filterItems = QString("<ul>");
     for (const auto &item : filterList) {
         filterItems.append(QString("<li>%1</li>").arg(item));
@@ -257,60 +496,356 @@ void MainWindow::showAboutDialog() {
 
 void MainWindow::openFile() {
     Logger::debug("File opening");
-    auto fileName = QFileDialog::getOpenFileName(this, tr("Open Log File"), "",
-                                                 tr("Log Files (*.log)"));
+    // archives only of the formats whose library was built in
+    QString patterns = "*.log";
+    if (LogDecompressor::isBuiltIn(LogDecompressor::Format::Gzip)) {
+        patterns += " *.gz";
+    }
+    if (LogDecompressor::isBuiltIn(LogDecompressor::Format::Zstd)) {
+        patterns += " *.zst";
+    }
+    auto fileName = QFileDialog::getOpenFileName(
+        this, tr("Open Log File"), "",
+        tr("Log Files (%1);;All Files (*)").arg(patterns));
     if (fileName.isEmpty()) {
         return;
     }
     Logger::debug("File name: {}", fileName.toStdString());
-    m_currentLog = new QFileInfo(fileName);
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        Logger::error("Failed to open file: {}", fileName.toStdString());
+    auto logFile = std::make_shared<LogFile>(fileName);
+    if (!logFile->open()) {
         return;
     }
-    QTextStream in(&file);
-    m_logText->setPlainText(in.readAll());
-    file.close();
+    if (!LogDecompressor::isBuiltIn(LogDecompressor::formatOf(*logFile))) {
+        Logger::error("Compression format not built in: {}",
+                      fileName.toStdString());
+        statusBar()->showMessage(
+            tr("Cannot open %1: its compression format is not built in")
+                .arg(QFileInfo(fileName).fileName()));
+        return;
+    }
+    statusBar()->clearMessage();
+    m_logFile = logFile;
+    m_currentLog = new QFileInfo(fileName);
+    m_logDelegate->clearCache();
+    m_logModel->clear();
+    m_timeline->clear();
     updateLogFileNameFromFile();
-    emit m_logTextProcessor->logTextLoaded(m_logText->toHtml());
+    emit m_logTextProcessor->logFileLoaded(m_logFile);
     Logger::debug("File opened");
 }
 
-void MainWindow::updateLogText(const QString &logTextHtml) {
+void MainWindow::updateLogDocument(
+    std::shared_ptr<const LogDocument> document,
+    std::shared_ptr<const VisibleLines> lines,
+    std::shared_ptr<const RepeatRuns> runs) {
+    if (m_logFile == nullptr || document->source() != m_logFile) {
+        return;  // document of a file that is no longer shown
+    }
+    auto shown = m_logModel->document();
+    // the followed file was replaced, or its last line was taken back to
+    // be parsed again once it ends
+    if (shown != nullptr && (shown->generation() != document->generation() ||
+                             shown->lineCount() > document->lineCount())) {
+        m_logDelegate->clearCache();
+    }
+    m_logModel->setLogDocument(document, lines, runs);
+    m_timeline->setLogDocument(document);
+    if (!m_timeRangeBox->isChecked()) {
+        // an unused range follows the times of the log
+        const auto &timeIndex = document->timeIndex();
+        m_timeFromEdit->setDateTime(toDateTime(timeIndex.minimum()));
+        m_timeToEdit->setDateTime(toDateTime(timeIndex.maximum()));
+    }
+}
+
+void MainWindow::updateLoadingProgress(qint64 loadedBytes,
+                                       qint64 totalBytes) {
+    if (m_logFile == nullptr || loadedBytes >= totalBytes) {
+        m_loadingProgress->hide();
+        return;
+    }
+    m_loadingProgress->setValue(static_cast<int>(loadedBytes * 1000 /
+                                                 totalBytes));
+    m_loadingProgress->show();
+}
+
+void MainWindow::updateLogLines(std::shared_ptr<const LogDocument> document,
+                                std::shared_ptr<const VisibleLines> lines,
+                                std::shared_ptr<const RepeatRuns> runs) {
     if (m_currentLog == nullptr) {  // no file opened
         return;
     }
     Logger::debug("Log view updating");
-    m_logText->setHtml(logTextHtml);
+    m_logModel->setFilteredLines(document, lines, runs);
     Logger::debug("Log view updated");
 }
 
+void MainWindow::toggleRepeatRun(int row) {
+    auto index = m_logModel->index(row);
+    if (!index.data(LogListModel::RepeatCountRole).isValid()) {
+        return;
+    }
+    auto expanded = index.data(LogListModel::RepeatExpandedRole).toBool();
+    emit m_logTextProcessor->repeatRunExpanded(m_logModel->lineAt(row),
+                                               !expanded);
+}
+
+void MainWindow::searchLogText() {
+    m_searchTimer->stop();
+    auto text = m_searchEdit->text();
+    auto matchCase = m_matchCaseBox->isChecked();
+    auto isRegex = m_regexBox->isChecked();
+    Logger::debug("Search: {}", text.toStdString());
+    // the highlight is compiled here once, the processor compiles its own
+    QRegularExpression highlight(
+        isRegex ? text : QRegularExpression::escape(text),
+        matchCase ? QRegularExpression::NoPatternOption
+                  : QRegularExpression::CaseInsensitiveOption);
+    if (!text.isEmpty() && !highlight.isValid()) {
+        statusBar()->showMessage(tr("Invalid regular expression: %1")
+                                     .arg(highlight.errorString()));
+        return;
+    }
+    statusBar()->clearMessage();
+    highlight.optimize();
+    m_logDelegate->setHighlight(text.isEmpty() ? QRegularExpression()
+                                               : highlight);
+    m_logView->viewport()->update();
+    emit m_logTextProcessor->searchChanged(text, matchCase, isRegex);
+}
+
+void MainWindow::filterTimeRange() {
+    if (!m_timeRangeBox->isChecked()) {
+        return;  // the edits follow the times of the log while it loads
+    }
+    // the edits show milliseconds, the range covers their microseconds
+    auto from = toMicros(m_timeFromEdit->dateTime());
+    auto to = toMicros(m_timeToEdit->dateTime()) + 999;
+    emit m_logTextProcessor->timeRangeChanged(true, from, to);
+}
+
+void MainWindow::goToTime() {
+    auto document = m_logModel->document();
+    if (document == nullptr || m_logModel->rowCount() == 0) {
+        return;
+    }
+    const auto &timeIndex = document->timeIndex();
+    // lines before the first header have no time
+    auto currentRow = m_logView->currentRow();
+    auto current =
+        currentRow >= 0 && currentRow < m_logModel->rowCount() &&
+                m_logModel->lineAt(currentRow) >= timeIndex.preambleRows()
+            ? timeIndex.timestamp(m_logModel->lineAt(currentRow))
+            : timeIndex.minimum();
+    bool ok = false;
+    auto text = QInputDialog::getText(
+        this, tr("Go to Time"), tr("Time (%1):").arg(TimeFormat),
+        QLineEdit::Normal, toDateTime(current).toString(TimeFormat), &ok);
+    if (!ok) {
+        return;
+    }
+    auto dateTime = QDateTime::fromString(text.trimmed(), TimeFormat);
+    if (!dateTime.isValid()) {
+        statusBar()->showMessage(tr("Invalid time: %1").arg(text));
+        return;
+    }
+    dateTime.setTimeZone(QTimeZone::utc());
+    statusBar()->clearMessage();
+    showTime(toMicros(dateTime));
+}
+
+void MainWindow::showTime(qint64 time) {
+    auto document = m_logModel->document();
+    if (document == nullptr) {
+        return;
+    }
+    // the shown document may lag behind the loading one, its index covers
+    // its rows
+    auto line = document->timeIndex().lowerBound(time);
+    auto row = m_logModel->rowOf(static_cast<std::uint32_t>(line));
+    Logger::debug("Show time: line {}, row {}", line, row);
+    m_logView->setCurrentRow(row);
+    m_logView->setFocus();
+}
+
 void MainWindow::closeFile() {
     Logger::debug("File closing");
     m_currentLog = nullptr;
-    m_logText->clear();
-    emit m_logTextProcessor->logTextLoaded("");
+    m_logDelegate->clearCache();
+    m_logModel->clear();
+    m_timeline->clear();
+    m_loadingProgress->hide();
+    m_logFile.reset();
+    emit m_logTextProcessor->logFileLoaded(nullptr);
     Logger::debug("File closed");
 }
 
-void MainWindow::updateLevelCheckBoxes(
-    const std::vector<QCheckBox *> &levelCheckBoxes) {
-    for (auto checkBox : levelCheckBoxes) {
-        m_levelCheckBoxLayout->addWidget(checkBox);
+void MainWindow::updateLevelCheckBoxes(const std::vector<LogLevel> &levels,
+                                       std::uint8_t levelMask) {
+    Logger::debug("Level checkboxes updating");
+    // called again whenever loading finds more levels, levels that were
+    // already enabled keep the state the user gave them. A level found
+    // later shows the state the filter gave it
+    for (auto button : m_levelChoiceGroup->buttons()) {
+        auto id = m_levelChoiceGroup->id(button);
+        if (id == 0) {
+            button->setEnabled(!levels.empty());
+            continue;
+        }
+        auto enabled = std::find(levels.begin(), levels.end(),
+                                 static_cast<LogLevel>(id - 1)) != levels.end();
+        if (enabled != button->isEnabled()) {
+            button->setEnabled(enabled);
+            button->setChecked(enabled && ((levelMask >> (id - 1)) & 1));
+        }
     }
+    updateAllCheckBox(m_levelChoiceGroup);
+    Logger::debug("Level checkboxes updated");
 }
 
 void MainWindow::updateClassCheckBoxes(
-    const std::vector<QCheckBox *> &classCheckBoxes) {
-    for (auto checkBox : m_previousClassCheckBoxes) {
-        m_classCheckBoxLayout->removeWidget(checkBox);
-        delete checkBox;
+    const std::vector<QString> &classNames, const std::vector<bool> &checked) {
+    Logger::debug("Class checkboxes updating");
+    // ids only grow while a file loads, an empty list starts a new file
+    std::vector<QAbstractButton *> classButtons;
+    for (auto button : m_classChoiceGroup->buttons()) {
+        auto id = m_classChoiceGroup->id(button);
+        if (id == 0) {
+            continue;
+        }
+        if (static_cast<std::size_t>(id) > classNames.size()) {
+            m_classChoiceGroup->removeButton(button);
+            m_classCheckBoxLayout->removeWidget(button);
+            delete button;
+        } else {
+            classButtons.push_back(button);
+        }
+    }
+
+    // sidebar lists classes by name, buttons are keyed by class id
+    auto byName = [](QAbstractButton *a, QAbstractButton *b) {
+        return a->text() < b->text();
+    };
+    std::sort(classButtons.begin(), classButtons.end(), byName);
+    for (auto classId = classButtons.size(); classId < classNames.size();
+         classId++) {
+        auto button = new QCheckBox(classNames[classId], this);
+        button->setChecked(checked[classId]);
+        m_classChoiceGroup->addButton(button, static_cast<int>(classId) + 1);
+        auto position = std::lower_bound(classButtons.begin(),
+                                         classButtons.end(), button, byName);
+        // layout index 0 is the "All" button
+        m_classCheckBoxLayout->insertWidget(
+            static_cast<int>(position - classButtons.begin()) + 1, button);
+        classButtons.insert(position, button);
     }
-    m_previousClassCheckBoxes = classCheckBoxes;
-    for (auto checkBox : classCheckBoxes) {
-        m_classCheckBoxLayout->addWidget(checkBox);
+    m_classChoiceGroup->button(0)->setEnabled(!classNames.empty());
+    updateAllCheckBox(m_classChoiceGroup);
+    Logger::debug("Class checkboxes updated: {}", classNames.size());
+}
+
+void MainWindow::levelCheckBoxClicked(int id) {
+    auto checked = m_levelChoiceGroup->button(id)->isChecked();
+    if (id == 0) {
+        for (auto button : m_levelChoiceGroup->buttons()) {
+            if (button->isEnabled()) {
+                button->setChecked(checked);
+            }
+        }
+        emit m_logTextProcessor->allLevelsFilterChanged(checked);
+    } else {
+        emit m_logTextProcessor->levelFilterChanged(
+            static_cast<LogLevel>(id - 1), checked);
+        updateAllCheckBox(m_levelChoiceGroup);
+    }
+}
+
+void MainWindow::classCheckBoxClicked(int id) {
+    auto checked = m_classChoiceGroup->button(id)->isChecked();
+    if (id == 0) {
+        for (auto button : m_classChoiceGroup->buttons()) {
+            button->setChecked(checked);
+        }
+        emit m_logTextProcessor->allClassesFilterChanged(checked);
+    } else {
+        emit m_logTextProcessor->classFilterChanged(
+            static_cast<std::uint32_t>(id - 1), checked);
+        updateAllCheckBox(m_classChoiceGroup);
+    }
+}
+
+void MainWindow::updateTemplateList(
+    const std::vector<TemplateSummary> &templates) {
+    // ids restart from 0 with every file, an empty list starts it. A
+    // followed last line parsed again may take back the latest template
+    QSignalBlocker blocker(m_templateList);
+    while (m_templateItems.size() > templates.size()) {
+        delete m_templateItems.back();
+        m_templateItems.pop_back();
+    }
+    m_templateList->setSortingEnabled(false);
+    for (std::size_t id = 0; id < templates.size(); id++) {
+        const auto &summary = templates[id];
+        if (id == m_templateItems.size()) {
+            auto item = new QTreeWidgetItem(m_templateList);
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(0, summary.checked ? Qt::Checked
+                                                   : Qt::Unchecked);
+            item->setData(0, Qt::UserRole, static_cast<quint32>(id));
+            m_templateItems.push_back(item);
+        }
+        // wildcards replace more tokens as records join a template
+        auto item = m_templateItems[id];
+        item->setText(0, summary.text);
+        item->setToolTip(0, summary.text);
+        item->setData(1, Qt::DisplayRole, summary.count);
+        item->setText(2, toDateTime(summary.first).toString(TimeFormat));
+        item->setText(3, toDateTime(summary.last).toString(TimeFormat));
+    }
+    m_templateList->setSortingEnabled(true);
+    m_allTemplatesBox->setEnabled(!templates.empty());
+    updateAllTemplatesBox();
+    Logger::debug("Template list updated: {}", templates.size());
+}
+
+void MainWindow::templateItemChanged(QTreeWidgetItem *item, int column) {
+    if (column != 0) {
+        return;
+    }
+    auto checked = item->checkState(0) == Qt::Checked;
+    emit m_logTextProcessor->templateFilterChanged(
+        item->data(0, Qt::UserRole).toUInt(), checked);
+    updateAllTemplatesBox();
+}
+
+void MainWindow::allTemplatesClicked(bool checked) {
+    {
+        QSignalBlocker blocker(m_templateList);
+        for (auto item : m_templateItems) {
+            item->setCheckState(0, checked ? Qt::Checked : Qt::Unchecked);
+        }
+    }
+    emit m_logTextProcessor->allTemplatesFilterChanged(checked);
+}
+
+void MainWindow::updateAllTemplatesBox() {
+    auto allChecked = std::all_of(
+        m_templateItems.begin(), m_templateItems.end(),
+        [](auto item) { return item->checkState(0) == Qt::Checked; });
+    m_allTemplatesBox->setChecked(allChecked);
+}
+
+void MainWindow::updateAllCheckBox(QButtonGroup *choiceGroup) {
+    auto allChecked = true;
+    for (auto button : choiceGroup->buttons()) {
+        if (choiceGroup->id(button) != 0 && button->isEnabled() &&
+            !button->isChecked()) {
+            allChecked = false;
+            break;
+        }
     }
+    auto allButton = choiceGroup->button(0);
+    allButton->setChecked(allChecked && allButton->isEnabled());
 }
 
 void MainWindow::updateLogFileNameFromFile() {
@@ -0,0 +1,61 @@
+#include <HotPath.h>
+#include <LogRecordParser.h>
+#include <ParallelLogParser.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+ParallelLogParser::ParallelLogParser(ThreadPool &pool) : m_pool(pool) {}
+
+void ParallelLogParser::parse(const LogText &text, bool atEnd,
+                              LineIndex &lineIndex, LogTable &table,
+                              LevelCounts &levelCounts) {
+    HOT_PATH_SCOPE("ParallelLogParser::parse");
+    const auto begin = lineIndex.indexedSize();
+    const auto end = text.end();
+    if (end <= begin) {
+        return;
+    }
+    const auto bytes = end - begin;
+    const auto chunkCount = static_cast<std::size_t>(std::clamp<std::uint64_t>(
+        bytes / MinChunkBytes, 1, m_pool.threadCount() * ChunksPerThread));
+
+    // chunk i covers [bounds[i], bounds[i + 1]), every bound but the last
+    // follows a line ending
+    std::vector<std::uint64_t> bounds(chunkCount + 1);
+    bounds[0] = begin;
+    bounds[chunkCount] = end;
+    for (std::size_t i = 1; i < chunkCount; i++) {
+        auto cut = std::max(begin + bytes * i / chunkCount, bounds[i - 1]);
+        auto newline = static_cast<const char *>(
+            std::memchr(text.at(cut), '\n', end - cut));
+        bounds[i] = newline == nullptr ? end : text.offsetOf(newline) + 1;
+    }
+
+    struct Chunk {
+        LineIndex lineIndex;
+        LogTable table;
+        LevelCounts levelCounts{};
+    };
+    std::vector<Chunk> chunks(chunkCount);
+    m_pool.parallelFor(chunkCount, [&](std::size_t i) {
+        auto &chunk = chunks[i];
+        chunk.lineIndex.reset(bounds[i]);
+        chunk.lineIndex.append(text.slice(bounds[i], bounds[i + 1]),
+                               atEnd && bounds[i + 1] == end);
+        LogRecordParser parser(chunk.table);
+        parser.parse(text, chunk.lineIndex, 0, chunk.lineIndex.lineCount());
+        chunk.table.countLevels(0, chunk.levelCounts);
+    });
+
+    // merged in file order, class ids follow the first appearance in the
+    // file whatever the chunking was
+    for (const auto &chunk : chunks) {
+        lineIndex.extend(chunk.lineIndex);
+        table.append(chunk.table);
+        for (std::size_t level = 0; level < LogLevelCount; level++) {
+            levelCounts[level] += chunk.levelCounts[level];
+        }
+    }
+}
@@ -0,0 +1,156 @@
+#include <RegexLiteral.h>
+
+#include <cctype>
+#include <cstring>
+
+namespace {
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// length of the quantifier at position, 0 if there is none. optional is set
+// when the quantified atom may be absent from a match
+std::size_t quantifierLength(std::string_view pattern, std::size_t position,
+                             bool &optional) {
+    if (position >= pattern.size()) {
+        return 0;
+    }
+    std::size_t length = 0;
+    auto c = pattern[position];
+    if (c == '?' || c == '*' || c == '+') {
+        optional = c != '+';
+        length = 1;
+    } else if (c == '{') {
+        // {n}, {n,} or {n,m}, anything else is a literal brace
+        auto end = position + 1;
+        while (end < pattern.size() && isDigit(pattern[end])) {
+            end++;
+        }
+        if (end == position + 1) {
+            return 0;
+        }
+        auto minimum = pattern.substr(position + 1, end - position - 1);
+        if (end < pattern.size() && pattern[end] == ',') {
+            end++;
+            while (end < pattern.size() && isDigit(pattern[end])) {
+                end++;
+            }
+        }
+        if (end >= pattern.size() || pattern[end] != '}') {
+            return 0;
+        }
+        optional = minimum.find_first_not_of('0') == std::string_view::npos;
+        length = end + 1 - position;
+    } else {
+        return 0;
+    }
+    // lazy or possessive suffix
+    auto next = position + length;
+    if (next < pattern.size() &&
+        (pattern[next] == '?' || pattern[next] == '+')) {
+        length++;
+    }
+    return length;
+}
+
+// end of the group or class starting at position, pattern.size() if open
+std::size_t skipGroup(std::string_view pattern, std::size_t position) {
+    int depth = 0;
+    for (auto i = position; i < pattern.size(); i++) {
+        auto c = pattern[i];
+        if (c == '\\') {
+            i++;
+        } else if (c == '[') {
+            // a leading ] or ^] belongs to the class
+            i++;
+            if (i < pattern.size() && pattern[i] == '^') {
+                i++;
+            }
+            if (i < pattern.size() && pattern[i] == ']') {
+                i++;
+            }
+            while (i < pattern.size() && pattern[i] != ']') {
+                i += pattern[i] == '\\' ? 2 : 1;
+            }
+            if (depth == 0) {
+                return i + 1;
+            }
+        } else if (c == '(') {
+            depth++;
+        } else if (c == ')' && --depth == 0) {
+            return i + 1;
+        }
+    }
+    return pattern.size();
+}
+
+std::size_t utf8Length(char lead) {
+    auto byte = static_cast<unsigned char>(lead);
+    return byte < 0xc0 ? 1 : byte < 0xe0 ? 2 : byte < 0xf0 ? 3 : 4;
+}
+}  // namespace
+
+namespace RegexLiteral {
+std::string required(std::string_view pattern, bool matchCase) {
+    if (pattern.find("(?") != std::string_view::npos ||
+        pattern.find("\\Q") != std::string_view::npos) {
+        return std::string();
+    }
+    std::string best;
+    std::string run;
+    auto endRun = [&] {
+        if (run.size() > best.size()) {
+            best = run;
+        }
+        run.clear();
+    };
+
+    std::size_t position = 0;
+    while (position < pattern.size()) {
+        auto c = pattern[position];
+        std::string atom;  // literal bytes of the next atom, empty if none
+        std::size_t atomEnd = position + 1;
+        if (c == '|') {
+            return std::string();  // an alternative may lack every run
+        } else if (c == '(' || c == '[') {
+            atomEnd = skipGroup(pattern, position);
+        } else if (c == '\\') {
+            if (position + 1 >= pattern.size()) {
+                return std::string();
+            }
+            auto escaped = pattern[position + 1];
+            atomEnd = position + 2;
+            if (std::isalnum(static_cast<unsigned char>(escaped))) {
+                // \d, \w, \b and the like match classes or positions,
+                // escapes taking arguments are not followed
+                if (std::strchr("dDwWsSbBAzZGhHvVRXKntrfae", escaped) ==
+                    nullptr) {
+                    return std::string();
+                }
+            } else {
+                atom = escaped;
+            }
+        } else if (c == '.' || c == '^' || c == '$') {
+            // matches a class or a position
+        } else {
+            atomEnd = position + utf8Length(c);
+            atom = pattern.substr(position, atomEnd - position);
+            if (!matchCase && static_cast<unsigned char>(c) >= 0x80) {
+                atom.clear();  // folded by the regex, not by the prefilter
+            }
+        }
+
+        bool optional = false;
+        auto quantifier = quantifierLength(pattern, atomEnd, optional);
+        if (atom.empty() || optional) {
+            endRun();
+        } else {
+            run += atom;
+            if (quantifier != 0) {  // repeated, the run cannot go on
+                endRun();
+            }
+        }
+        position = atomEnd + quantifier;
+    }
+    endRun();
+    return best;
+}
+}  // namespace RegexLiteral
@@ -0,0 +1,151 @@
+#include <HotPath.h>
+#include <RepeatFolder.h>
+
+#include <algorithm>
+
+namespace {
+constexpr std::uint64_t HashBasis = 0xcbf29ce484222325ull;
+constexpr std::uint64_t HashPrime = 0x100000001b3ull;
+// stands in for every token containing a digit
+constexpr std::uint64_t MaskedToken = 0x9e3779b97f4a7c15ull;
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// numbers, hex ids and uuids are single tokens
+bool isTokenChar(char c) {
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '_' || c == '-';
+}
+
+void mix(std::uint64_t &hash, std::uint64_t value) {
+    hash = (hash ^ value) * HashPrime;
+}
+}  // namespace
+
+RepeatFolder::RepeatFolder() : m_resumeRecord(0) {}
+
+void RepeatFolder::reset() {
+    m_keys.clear();
+    m_expanded.clear();
+    m_folded.reset(0, false);
+    m_runs.clear();
+    m_resumeRecord = 0;
+}
+
+void RepeatFolder::index(const LogText &text, const LogTable &table) {
+    HOT_PATH_SCOPE("RepeatFolder::index");
+    const auto records = table.recordCount();
+    m_keys.reserve(records);
+    for (auto record = m_keys.size(); record < records; record++) {
+        auto header = table.recordBegin(record);
+        const auto offset = table.messageOffsets[header];
+        const auto end = offset + table.messageLengths[header];
+        if (!text.contains(offset, end)) {
+            break;
+        }
+        m_keys.push_back(templateKey(table.levels[header],
+                                     table.classIds[header], text.at(offset),
+                                     text.at(end)));
+    }
+}
+
+void RepeatFolder::truncate(std::size_t recordCount) {
+    if (recordCount < m_keys.size()) {
+        m_keys.resize(recordCount);
+    }
+    m_resumeRecord = std::min(m_resumeRecord, recordCount);
+}
+
+void RepeatFolder::fold(const VisibleLines &visible, const LogTable &table) {
+    HOT_PATH_SCOPE("RepeatFolder::fold");
+    m_folded = visible;
+    m_runs.clear();
+    foldRecords(visible, table, 0);
+}
+
+void RepeatFolder::extend(const VisibleLines &visible,
+                          const LogTable &table) {
+    HOT_PATH_SCOPE("RepeatFolder::extend");
+    // the last run is folded again with the records that may join it
+    const auto first = m_resumeRecord;
+    const auto firstLine = first < table.recordCount()
+                               ? table.recordBegin(first)
+                               : m_folded.lineCount();
+    while (!m_runs.empty() && m_runs.back().line >= firstLine) {
+        m_runs.pop_back();
+    }
+    m_folded.resize(visible.lineCount());
+    for (auto line = firstLine; line < visible.lineCount(); line++) {
+        m_folded.set(static_cast<std::uint32_t>(line),
+                     visible.contains(static_cast<std::uint32_t>(line)));
+    }
+    foldRecords(visible, table, first);
+}
+
+void RepeatFolder::setExpanded(std::uint32_t line, bool expanded) {
+    if (expanded) {
+        m_expanded.insert(line);
+    } else {
+        m_expanded.erase(line);
+    }
+}
+
+std::uint64_t RepeatFolder::templateKey(std::uint8_t level,
+                                        std::uint32_t classId,
+                                        const char *begin, const char *end) {
+    auto hash = HashBasis;
+    mix(hash, level);
+    mix(hash, classId);
+    for (auto current = begin; current != end;) {
+        if (!isTokenChar(*current)) {
+            mix(hash, static_cast<unsigned char>(*current++));
+            continue;
+        }
+        auto token = HashBasis;
+        bool masked = false;
+        for (; current != end && isTokenChar(*current); current++) {
+            masked |= isDigit(*current);
+            mix(token, static_cast<unsigned char>(*current));
+        }
+        mix(hash, masked ? MaskedToken : token);
+    }
+    return hash;
+}
+
+void RepeatFolder::foldRecords(const VisibleLines &visible,
+                               const LogTable &table,
+                               std::size_t firstRecord) {
+    // records are visible or hidden as a whole, their first line tells
+    const auto records = table.recordCount();
+    RepeatRun run{0, 0, 0, false};
+    std::uint64_t runKey = 0;
+    m_resumeRecord = firstRecord;
+    for (auto record = firstRecord; record < records; record++) {
+        auto line = static_cast<std::uint32_t>(table.recordBegin(record));
+        if (!visible.contains(line)) {
+            continue;
+        }
+        const auto key = m_keys[record];
+        if (run.count != 0 && key == runKey) {
+            run.count++;
+            run.lastLine = line;
+            if (!run.expanded) {
+                auto end = table.recordEnd(record);
+                for (auto hidden = line; hidden < end; hidden++) {
+                    m_folded.set(hidden, false);
+                }
+            }
+            continue;
+        }
+        if (run.count > 1) {
+            m_runs.push_back(run);
+        }
+        run = {line, line, 1, m_expanded.count(line) != 0};
+        runKey = key;
+        m_resumeRecord = record;
+    }
+    if (run.count > 1) {
+        m_runs.push_back(run);
+    }
+    m_folded.updateRanks();
+}
@@ -0,0 +1,31 @@
+#include <Simd.h>
+
+namespace Simd {
+static bool detectAvx2() {
+#if !defined(LOGREADER_SIMD_X86)
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 &&
+                      (_xgetbv(0) & 0x6) == 0x6;  // OSXSAVE, XMM and YMM
+    if (!osSavesYmm) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool hasAvx2() {
+    static const bool supported = detectAvx2();
+    return supported;
+}
+}  // namespace Simd
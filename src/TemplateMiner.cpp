@@ -0,0 +1,295 @@
+#include <HotPath.h>
+#include <TemplateMiner.h>
+
+#include <algorithm>
+
+namespace {
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+std::uint64_t pack(std::uint32_t high, std::uint32_t low) {
+    return static_cast<std::uint64_t>(high) << 32 | low;
+}
+}  // namespace
+
+TemplateMiner::TemplateMiner() { clear(); }
+
+void TemplateMiner::clear() {
+    m_tokenDictionary.clear();
+    m_wildcard = m_tokenDictionary.intern("<*>");
+    m_templates.clear();
+    m_nodes.clear();
+    m_children.clear();
+    m_groups.clear();
+}
+
+void TemplateMiner::index(const LogText &text, LogTable &table) {
+    HOT_PATH_SCOPE("TemplateMiner::index");
+    const auto records = table.recordCount();
+    table.templateIds.reserve(records);
+    for (auto record = table.templateIds.size(); record < records;
+         record++) {
+        auto header = table.recordBegin(record);
+        if (table.levels[header] == LogTable::NoLevel) {
+            table.templateIds.push_back(LogTable::NoTemplate);
+            continue;
+        }
+        const auto offset = table.messageOffsets[header];
+        const auto end = offset + table.messageLengths[header];
+        if (!text.contains(offset, end)) {
+            break;
+        }
+        table.templateIds.push_back(assign(table.classIds[header],
+                                           table.timestamps[header],
+                                           text.at(offset), text.at(end)));
+    }
+}
+
+void TemplateMiner::forget(const LogTable &table, std::size_t firstRecord) {
+    // backwards, so a template created by these records is the latest one
+    // when its count drops to zero
+    for (auto record = table.templateIds.size(); record > firstRecord;
+         record--) {
+        const auto id = table.templateIds[record - 1];
+        if (id == LogTable::NoTemplate || --m_templates[id].count != 0 ||
+            id + 1 != m_templates.size()) {
+            continue;
+        }
+        for (auto &node : m_nodes) {
+            if (!node.templates.empty() && node.templates.back() == id) {
+                node.templates.pop_back();
+            }
+        }
+        m_templates.pop_back();
+    }
+}
+
+std::string TemplateMiner::text(std::uint32_t id) const {
+    std::string result;
+    for (auto token : m_templates[id].tokens) {
+        if (!result.empty()) {
+            result += ' ';
+        }
+        result += m_tokenDictionary.name(token);
+    }
+    return result;
+}
+
+void TemplateMiner::save(IndexWriter &writer) const {
+    writer.write<std::uint64_t>(m_tokenDictionary.size());
+    for (std::uint32_t token = 0; token < m_tokenDictionary.size();
+         token++) {
+        writer.writeString(m_tokenDictionary.name(token));
+    }
+    writer.write<std::uint64_t>(m_templates.size());
+    for (const auto &minedTemplate : m_templates) {
+        writer.write(minedTemplate.classId);
+        writer.writeArray(minedTemplate.tokens.data(),
+                          minedTemplate.tokens.size());
+        writer.write(minedTemplate.count);
+        writer.write(minedTemplate.first);
+        writer.write(minedTemplate.last);
+    }
+    writer.write<std::uint64_t>(m_nodes.size());
+    for (const auto &node : m_nodes) {
+        writer.write(node.childCount);
+        writer.writeArray(node.templates.data(), node.templates.size());
+    }
+    for (const auto *edges : {&m_children, &m_groups}) {
+        writer.write<std::uint64_t>(edges->size());
+        for (const auto &[key, node] : *edges) {
+            writer.write(key);
+            writer.write(node);
+        }
+    }
+}
+
+void TemplateMiner::load(IndexReader &reader) {
+    clear();
+    m_tokenDictionary.clear();  // the saved tokens start with the wildcard
+    auto tokenCount = reader.read<std::uint64_t>();
+    for (std::uint64_t token = 0; token < tokenCount && reader.ok();
+         token++) {
+        m_tokenDictionary.intern(reader.readString());
+    }
+    auto templateCount = reader.read<std::uint64_t>();
+    for (std::uint64_t id = 0; id < templateCount && reader.ok(); id++) {
+        Template minedTemplate;
+        minedTemplate.classId = reader.read<std::uint32_t>();
+        minedTemplate.tokens = reader.readVector<std::uint32_t>();
+        minedTemplate.count = reader.read<std::uint64_t>();
+        minedTemplate.first = reader.read<std::int64_t>();
+        minedTemplate.last = reader.read<std::int64_t>();
+        m_templates.push_back(std::move(minedTemplate));
+    }
+    auto nodeCount = reader.read<std::uint64_t>();
+    for (std::uint64_t i = 0; i < nodeCount && reader.ok(); i++) {
+        Node node;
+        node.childCount = reader.read<std::uint32_t>();
+        node.templates = reader.readVector<std::uint32_t>();
+        m_nodes.push_back(std::move(node));
+    }
+    for (auto *edges : {&m_children, &m_groups}) {
+        auto edgeCount = reader.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < edgeCount && reader.ok(); i++) {
+            auto key = reader.read<std::uint64_t>();
+            edges->emplace(key, reader.read<std::uint32_t>());
+        }
+    }
+    if (m_tokenDictionary.size() != tokenCount ||
+        m_tokenDictionary.find("<*>") != m_wildcard || !isConsistent()) {
+        reader.fail();
+    }
+}
+
+bool TemplateMiner::isConsistent() const {
+    for (const auto &minedTemplate : m_templates) {
+        for (auto token : minedTemplate.tokens) {
+            if (token >= m_tokenDictionary.size()) {
+                return false;
+            }
+        }
+    }
+    // token count of the messages routed through every node, a node has
+    // one parent that was created before it
+    constexpr auto NoLength = ~std::size_t(0);
+    std::vector<std::size_t> lengths(m_nodes.size(), NoLength);
+    for (const auto &[key, node] : m_groups) {
+        if (node >= m_nodes.size() || lengths[node] != NoLength) {
+            return false;
+        }
+        lengths[node] = static_cast<std::uint32_t>(key);
+    }
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> edges;
+    for (const auto &[key, node] : m_children) {
+        auto parent = key >> 32;
+        if (parent >= node || node >= m_nodes.size()) {
+            return false;
+        }
+        edges.emplace_back(parent, node);
+    }
+    std::sort(edges.begin(), edges.end());
+    for (auto [parent, node] : edges) {
+        if (lengths[parent] == NoLength || lengths[node] != NoLength) {
+            return false;
+        }
+        lengths[node] = lengths[parent];
+    }
+    // the templates of a leaf are compared token by token with a message
+    for (std::size_t node = 0; node < m_nodes.size(); node++) {
+        for (auto id : m_nodes[node].templates) {
+            if (id >= m_templates.size() ||
+                m_templates[id].tokens.size() != lengths[node]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::uint32_t TemplateMiner::assign(std::uint32_t classId,
+                                    std::int64_t timestamp,
+                                    const char *begin, const char *end) {
+    tokenize(begin, end);
+    const auto length = static_cast<std::uint32_t>(m_tokens.size());
+
+    // fixed depth descent, class and token count first
+    auto group = m_groups.find(pack(classId, length));
+    std::uint32_t node;
+    if (group == m_groups.end()) {
+        node = newNode();
+        m_groups.emplace(pack(classId, length), node);
+    } else {
+        node = group->second;
+    }
+    for (std::size_t depth = 0; depth < PrefixDepth && depth < length;
+         depth++) {
+        node = child(node, m_tokens[depth]);
+    }
+
+    // the most similar template of the leaf, ties go to the more general
+    std::uint32_t best = LogTable::NoTemplate;
+    std::size_t bestEqual = 0;
+    std::size_t bestWildcards = 0;
+    for (auto id : m_nodes[node].templates) {
+        const auto &tokens = m_templates[id].tokens;
+        std::size_t equal = 0;
+        std::size_t wildcards = 0;
+        // a wildcard of the message matches the one of the template, or
+        // messages of numbers only would never join their own template
+        for (std::size_t i = 0; i < length; i++) {
+            if (tokens[i] == m_tokens[i]) {
+                equal++;
+            }
+            if (tokens[i] == m_wildcard) {
+                wildcards++;
+            }
+        }
+        if (best == LogTable::NoTemplate || equal > bestEqual ||
+            (equal == bestEqual && wildcards > bestWildcards)) {
+            best = id;
+            bestEqual = equal;
+            bestWildcards = wildcards;
+        }
+    }
+    if (best != LogTable::NoTemplate &&
+        (length == 0 || bestEqual >= SimilarityThreshold * length)) {
+        auto &matched = m_templates[best];
+        for (std::size_t i = 0; i < length; i++) {
+            if (matched.tokens[i] != m_tokens[i]) {
+                matched.tokens[i] = m_wildcard;
+            }
+        }
+        matched.count++;
+        matched.first = std::min(matched.first, timestamp);
+        matched.last = std::max(matched.last, timestamp);
+        return best;
+    }
+
+    auto id = static_cast<std::uint32_t>(m_templates.size());
+    m_templates.push_back({classId, m_tokens, 1, timestamp, timestamp});
+    m_nodes[node].templates.push_back(id);
+    return id;
+}
+
+void TemplateMiner::tokenize(const char *begin, const char *end) {
+    m_tokens.clear();
+    auto current = begin;
+    while (current != end) {
+        while (current != end && isSpace(*current)) {
+            current++;
+        }
+        auto tokenBegin = current;
+        bool hasDigit = false;
+        while (current != end && !isSpace(*current)) {
+            hasDigit |= isDigit(*current);
+            current++;
+        }
+        if (current == tokenBegin) {
+            break;
+        }
+        std::string_view token(tokenBegin, current - tokenBegin);
+        m_tokens.push_back(hasDigit ? m_wildcard
+                                    : m_tokenDictionary.intern(token));
+    }
+}
+
+std::uint32_t TemplateMiner::child(std::uint32_t node, std::uint32_t token) {
+    auto found = m_children.find(pack(node, token));
+    if (found != m_children.end()) {
+        return found->second;
+    }
+    // a full node routes every new token to its wildcard child
+    if (token != m_wildcard && m_nodes[node].childCount >= MaxChildren) {
+        return child(node, m_wildcard);
+    }
+    auto created = newNode();
+    m_nodes[node].childCount++;
+    m_children.emplace(pack(node, token), created);
+    return created;
+}
+
+std::uint32_t TemplateMiner::newNode() {
+    m_nodes.emplace_back();
+    return static_cast<std::uint32_t>(m_nodes.size() - 1);
+}
@@ -0,0 +1,100 @@
+#include <ThreadPool.h>
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+    : m_queued(0), m_stopping(false) {
+    auto workers = std::max<std::size_t>(threadCount, 1) - 1;
+    for (std::size_t i = 0; i <= workers; i++) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < workers; i++) {
+        m_threads.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count,
+                             const std::function<void(std::size_t)> &task) {
+    if (count == 0) {
+        return;
+    }
+    // guarded by doneMutex, the last task notifies while holding it so the
+    // caller cannot return while a worker still touches this frame
+    std::size_t remaining = count;
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    for (std::size_t i = 0; i < count; i++) {
+        auto &queue = *m_queues[i % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.emplace_back([&, i] {
+            task(i);
+            std::lock_guard<std::mutex> doneLock(doneMutex);
+            if (--remaining == 0) {
+                done.notify_all();
+            }
+        });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued += count;
+    }
+    m_wakeUp.notify_all();
+
+    const auto callerQueue = m_queues.size() - 1;
+    while (runOne(callerQueue)) {
+    }
+    // the rest is running on the workers
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+bool ThreadPool::runOne(std::size_t index) {
+    std::function<void()> task;
+    {
+        auto &queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+    for (std::size_t i = 1; !task && i < m_queues.size(); i++) {
+        auto &queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    m_queued--;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    for (;;) {
+        if (runOne(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait(lock, [this] { return m_stopping || m_queued != 0; });
+        if (m_stopping && m_queued == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#include <HotPath.h>
+#include <TimeIndex.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+// block summaries without any record, inside every range and before every
+// time
+constexpr auto NoMinimum = std::numeric_limits<std::int64_t>::max();
+constexpr auto NoMaximum = std::numeric_limits<std::int64_t>::min();
+}  // namespace
+
+void TimeIndex::clear() {
+    m_preambleRows = 0;
+    m_timestamps.clear();
+    m_minimums.clear();
+    m_maximums.clear();
+    m_latest.clear();
+}
+
+void TimeIndex::index(const LogTable &table) {
+    HOT_PATH_SCOPE("TimeIndex::index");
+    // the last block may have been partial, it is summarized again
+    m_timestamps = table.timestamps;
+    const auto rows = m_timestamps.size();
+    const auto blocks = (rows + RowsPerBlock - 1) / RowsPerBlock;
+    auto block = std::min(m_minimums.size(), blocks);
+    block = block == 0 ? 0 : block - 1;
+    // the preamble only grows while it is all there is, the blocks before
+    // the last one stay without records
+    m_preambleRows = 0;
+    if (rows != 0 && table.levels[0] == LogTable::NoLevel) {
+        m_preambleRows = table.records.size() > 1 ? table.records[1] : rows;
+    }
+    m_minimums.resize(blocks);
+    m_maximums.resize(blocks);
+    m_latest.resize(blocks);
+    const auto timestamps = m_timestamps.data();
+    for (; block < blocks; block++) {
+        auto first = timestamps +
+                     std::max(block * RowsPerBlock, m_preambleRows);
+        auto last = timestamps + std::min(rows, (block + 1) * RowsPerBlock);
+        auto minimum = NoMinimum;
+        auto maximum = NoMaximum;
+        if (first < last) {
+            auto [lowest, highest] = std::minmax_element(first, last);
+            minimum = *lowest;
+            maximum = *highest;
+        }
+        m_minimums.set(block, minimum);
+        m_maximums.set(block, maximum);
+        m_latest.set(block, block == 0
+                                ? maximum
+                                : std::max(m_latest[block - 1], maximum));
+    }
+}
+
+std::int64_t TimeIndex::minimum() const {
+    if (m_minimums.empty()) {
+        return 0;
+    }
+    auto minimum = *std::min_element(m_minimums.begin(), m_minimums.end());
+    return minimum == NoMinimum ? 0 : minimum;
+}
+
+std::int64_t TimeIndex::maximum() const {
+    return m_latest.empty() || m_latest.back() == NoMaximum ? 0
+                                                             : m_latest.back();
+}
+
+std::size_t TimeIndex::lowerBound(std::int64_t time) const {
+    // every block before the first one reaching time is entirely earlier
+    auto block = std::lower_bound(m_latest.begin(), m_latest.end(), time) -
+                 m_latest.begin();
+    if (static_cast<std::size_t>(block) == m_latest.size()) {
+        return rowCount();
+    }
+    auto first = m_timestamps.begin() +
+                 std::max(block * RowsPerBlock, m_preambleRows);
+    auto last = m_timestamps.begin() +
+                std::min(m_timestamps.size(), (block + 1) * RowsPerBlock);
+    return std::find_if(first, last,
+                        [time](std::int64_t t) { return t >= time; }) -
+           m_timestamps.begin();
+}
+
+std::uint64_t TimeIndex::rangeBits(std::size_t word, std::int64_t from,
+                                   std::int64_t to) const {
+    const auto block = word * 64 / RowsPerBlock;
+    const auto first = word * 64;
+    if (m_minimums[block] >= from && m_maximums[block] <= to) {
+        return ~std::uint64_t(0);
+    }
+    if (first >= m_preambleRows &&
+        (m_maximums[block] < from || m_minimums[block] > to)) {
+        return 0;
+    }
+    const auto count = std::min<std::size_t>(64, m_timestamps.size() - first);
+    const auto timestamps = m_timestamps.data() + first;
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        bits |= static_cast<std::uint64_t>(first + i < m_preambleRows ||
+                                           (timestamps[i] >= from &&
+                                            timestamps[i] <= to))
+                << i;
+    }
+    return bits;
+}
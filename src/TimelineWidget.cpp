@@ -0,0 +1,145 @@
+#include <HotPath.h>
+#include <TimelineWidget.h>
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+
+TimelineWidget::TimelineWidget(QWidget *parent)
+    : QWidget(parent),
+      m_viewBegin(0),
+      m_viewEnd(0) {
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
+    setToolTip(tr("Records over time, click to show a time, scroll to "
+                  "zoom, double click to show the whole log"));
+}
+
+QSize TimelineWidget::sizeHint() const { return QSize(80, 200); }
+
+void TimelineWidget::clear() {
+    m_document.reset();
+    m_histogram.clear();
+    m_viewBegin = 0;
+    m_viewEnd = 0;
+    update();
+}
+
+void TimelineWidget::setLogDocument(
+    std::shared_ptr<const LogDocument> document) {
+    // fewer lines took back a last line, the histogram counts it again
+    if (m_document == nullptr ||
+        m_document->generation() != document->generation() ||
+        m_document->lineCount() > document->lineCount()) {
+        clear();
+    }
+    m_document = document;
+    m_histogram.index(document->table());
+    update();
+}
+
+std::int64_t TimelineWidget::viewBegin() const {
+    return isZoomed() ? m_viewBegin : m_histogram.begin();
+}
+
+std::int64_t TimelineWidget::viewEnd() const {
+    return isZoomed() ? m_viewEnd : m_histogram.end();
+}
+
+std::int64_t TimelineWidget::timeAt(int y) const {
+    auto span = viewEnd() - viewBegin();
+    return viewBegin() + span * std::clamp(y, 0, height()) /
+                             std::max(1, height());
+}
+
+void TimelineWidget::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    if (m_histogram.empty() || height() == 0) {
+        return;
+    }
+    HOT_PATH_SCOPE("TimelineWidget::paintEvent");
+    const auto begin = viewBegin();
+    const auto span = std::max<std::int64_t>(1, viewEnd() - begin);
+    // about one bucket per pixel row
+    const auto level = m_histogram.levelFor(span / height());
+    const auto bucketWidth = m_histogram.bucketWidth(level);
+    const auto &buckets = m_histogram.buckets(level);
+    const auto offset = std::max<std::int64_t>(0, begin - m_histogram.begin());
+    const auto first = static_cast<std::size_t>(offset / bucketWidth);
+    const auto last =
+        std::min(buckets.size(),
+                 static_cast<std::size_t>((offset + span) / bucketWidth + 1));
+
+    std::uint32_t maxCount = 1;
+    for (auto bucket = first; bucket < last; bucket++) {
+        std::uint32_t count = 0;
+        for (auto levelCount : buckets[bucket]) {
+            count += levelCount;
+        }
+        maxCount = std::max(maxCount, count);
+    }
+
+    auto yOf = [&](std::int64_t time) {
+        return static_cast<int>((time - begin) * height() / span);
+    };
+    for (auto bucket = first; bucket < last; bucket++) {
+        auto bucketBegin = m_histogram.begin() +
+                           static_cast<std::int64_t>(bucket) * bucketWidth;
+        auto top = yOf(bucketBegin);
+        auto bottom = std::max(top + 1, yOf(bucketBegin + bucketWidth));
+        // levels stacked from the left, the most severe last
+        int x = 0;
+        std::uint32_t count = 0;
+        for (std::size_t level = 0; level < LogLevelCount; level++) {
+            count += buckets[bucket][level];
+            auto right = static_cast<int>(
+                static_cast<std::uint64_t>(count) * width() / maxCount);
+            if (right > x) {
+                painter.fillRect(QRect(x, top, right - x, bottom - top),
+                                 QColor(LogLevelColors[level]));
+                x = right;
+            }
+        }
+    }
+}
+
+void TimelineWidget::mousePressEvent(QMouseEvent *event) {
+    if (m_histogram.empty() || event->button() != Qt::LeftButton) {
+        return;
+    }
+    emit timeClicked(timeAt(event->position().toPoint().y()));
+}
+
+void TimelineWidget::mouseDoubleClickEvent(QMouseEvent *event) {
+    Q_UNUSED(event);
+    m_viewBegin = 0;
+    m_viewEnd = 0;
+    update();
+}
+
+void TimelineWidget::wheelEvent(QWheelEvent *event) {
+    if (m_histogram.empty() || event->angleDelta().y() == 0) {
+        return;
+    }
+    // the time under the cursor stays in place
+    auto begin = viewBegin();
+    auto span = viewEnd() - begin;
+    auto center = timeAt(event->position().toPoint().y());
+    auto newSpan = event->angleDelta().y() > 0 ? span / 2 : span * 2;
+    newSpan = std::max(newSpan, m_histogram.bucketWidth(0) * MinBuckets);
+    auto newBegin =
+        center - (center - begin) * newSpan / std::max<std::int64_t>(1, span);
+    if (newSpan >= m_histogram.end() - m_histogram.begin()) {
+        m_viewBegin = 0;  // the whole log fits
+        m_viewEnd = 0;
+    } else {
+        newBegin = std::clamp(newBegin, m_histogram.begin(),
+                              m_histogram.end() - newSpan);
+        m_viewBegin = newBegin;
+        m_viewEnd = newBegin + newSpan;
+    }
+    update();
+    event->accept();
+}
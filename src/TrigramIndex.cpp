@@ -0,0 +1,245 @@
+#include <HotPath.h>
+#include <TrigramIndex.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+std::uint32_t fold(char c) {
+    auto byte = static_cast<unsigned char>(c);
+    return byte >= 'A' && byte <= 'Z' ? byte | 0x20 : byte;
+}
+}  // namespace
+
+TrigramIndex::TrigramIndex() : m_lineCount(0) {}
+
+void TrigramIndex::clear() {
+    m_lineCount = 0;
+    m_trigrams.clear();
+    m_postings.clear();
+    m_slots.clear();
+}
+
+void TrigramIndex::truncate(std::size_t lineCount) {
+    m_lineCount = std::min(m_lineCount, lineCount);
+}
+
+void TrigramIndex::save(IndexWriter &writer) const {
+    writer.write<std::uint64_t>(m_lineCount);
+    writer.writeArray(m_trigrams.data(), m_trigrams.size());
+    for (const auto &list : m_postings) {
+        writer.writeArray(list.data(), list.size());
+    }
+}
+
+void TrigramIndex::load(IndexReader &reader) {
+    clear();
+    auto lineCount = reader.read<std::uint64_t>();
+    auto trigrams = reader.readView<std::uint32_t>();
+    // blocks index the words of a VisibleLines bitmap of lineCount lines
+    const auto blockCount = (lineCount + LinesPerBlock - 1) / LinesPerBlock;
+    for (auto trigram : trigrams) {
+        auto blocks = reader.readVector<std::uint32_t>();
+        if (!blocks.empty() &&
+            (blocks.back() >= blockCount ||
+             std::adjacent_find(blocks.begin(), blocks.end(),
+                                std::greater_equal<std::uint32_t>()) !=
+                 blocks.end())) {
+            reader.fail();
+        }
+        if (!reader.ok()) {
+            clear();
+            return;
+        }
+        postings(trigram) = std::move(blocks);
+    }
+    m_lineCount = static_cast<std::size_t>(lineCount);
+}
+
+void TrigramIndex::index(const LogText &text, const LineIndex &lineIndex,
+                         ThreadPool &pool) {
+    const auto first = m_lineCount;
+    const auto last = lineIndex.linesBefore(text.end());
+    if (last <= first || lineIndex.lineBegin(first) < text.begin()) {
+        return;
+    }
+    HOT_PATH_SCOPE("TrigramIndex::index");
+    const auto lines = last - first;
+    const auto taskCount = std::clamp<std::size_t>(
+        lines / MinLinesPerTask, 1, pool.threadCount() * 4);
+    if (taskCount == 1) {
+        addLines(text, lineIndex, first, last);
+        return;
+    }
+
+    // tasks start on a block boundary so no block is split between them,
+    // except the first one that continues the last indexed block
+    std::vector<std::size_t> bounds(taskCount + 1);
+    bounds[0] = first;
+    bounds[taskCount] = last;
+    for (std::size_t i = 1; i < taskCount; i++) {
+        auto bound = first + lines * i / taskCount;
+        bounds[i] = std::max(bound - bound % LinesPerBlock, bounds[i - 1]);
+    }
+    std::vector<TrigramIndex> parts(taskCount);
+    pool.parallelFor(taskCount, [&](std::size_t i) {
+        parts[i].addLines(text, lineIndex, bounds[i], bounds[i + 1]);
+    });
+    for (const auto &part : parts) {
+        append(part);
+    }
+}
+
+std::vector<std::uint32_t> TrigramIndex::candidateBlocks(
+    std::string_view literal) const {
+    const auto blockCount = static_cast<std::uint32_t>(
+        (m_lineCount + LinesPerBlock - 1) / LinesPerBlock);
+    std::vector<std::uint32_t> blocks;
+    if (literal.size() < 3) {
+        blocks.resize(blockCount);
+        for (std::uint32_t block = 0; block < blockCount; block++) {
+            blocks[block] = block;
+        }
+        return blocks;
+    }
+
+    std::vector<const std::vector<std::uint32_t> *> lists;
+    std::uint32_t trigram = fold(literal[0]) << 8 | fold(literal[1]);
+    for (std::size_t i = 2; i < literal.size(); i++) {
+        trigram = (trigram << 8 | fold(literal[i])) & 0xffffff;
+        auto list = findPostings(trigram);
+        if (list == nullptr) {
+            return blocks;  // no block has this trigram
+        }
+        lists.push_back(list);
+    }
+    // intersect from the shortest list so every step stays small
+    std::sort(lists.begin(), lists.end(), [](auto a, auto b) {
+        return a->size() < b->size();
+    });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+    blocks = *lists.front();
+    std::vector<std::uint32_t> intersection;
+    for (std::size_t i = 1; i < lists.size() && !blocks.empty(); i++) {
+        intersection.clear();
+        std::set_intersection(blocks.begin(), blocks.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(intersection));
+        blocks.swap(intersection);
+    }
+    return blocks;
+}
+
+std::uint32_t TrigramIndex::hash(std::uint32_t trigram) {
+    auto value = trigram * 0x9e3779b1u;  // spreads the bytes to the low bits
+    return value ^ value >> 15;
+}
+
+void TrigramIndex::addLines(const LogText &text, const LineIndex &lineIndex,
+                            std::size_t firstLine, std::size_t lastLine) {
+    // the trigrams of a block are collected first so the posting lists are
+    // looked up once per distinct trigram instead of once per byte. The
+    // 2 MiB bitmap of seen trigrams is allocated once per thread, flush
+    // clears just the bits of its block so it is clear for the next call
+    thread_local std::vector<std::uint64_t> seen((1u << 24) / 64);
+    std::vector<std::uint32_t> blockTrigrams;
+    auto flush = [&](std::uint32_t block) {
+        for (auto trigram : blockTrigrams) {
+            seen[trigram >> 6] &= ~(std::uint64_t(1) << (trigram & 63));
+            auto &list = postings(trigram);
+            if (list.empty() || list.back() != block) {
+                list.push_back(block);
+            }
+        }
+        blockTrigrams.clear();
+    };
+
+    auto block = static_cast<std::uint32_t>(firstLine / LinesPerBlock);
+    for (auto line = firstLine; line < lastLine; line++) {
+        if (line / LinesPerBlock != block) {
+            flush(block);
+            block = static_cast<std::uint32_t>(line / LinesPerBlock);
+        }
+        auto begin = text.at(lineIndex.lineBegin(line));
+        auto end = text.at(lineIndex.lineEnd(line));
+        if (end > begin && end[-1] == '\n') {
+            end--;
+        }
+        if (end - begin < 3) {
+            continue;
+        }
+        std::uint32_t trigram = fold(begin[0]) << 8 | fold(begin[1]);
+        for (auto position = begin + 2; position < end; position++) {
+            trigram = (trigram << 8 | fold(*position)) & 0xffffff;
+            auto &word = seen[trigram >> 6];
+            auto bit = std::uint64_t(1) << (trigram & 63);
+            if ((word & bit) == 0) {
+                word |= bit;
+                blockTrigrams.push_back(trigram);
+            }
+        }
+    }
+    flush(block);
+    m_lineCount = lastLine;
+}
+
+void TrigramIndex::append(const TrigramIndex &next) {
+    for (std::size_t i = 0; i < next.m_trigrams.size(); i++) {
+        const auto &nextList = next.m_postings[i];
+        auto &list = postings(next.m_trigrams[i]);
+        auto first = nextList.begin();
+        if (!list.empty() && list.back() == *first) {  // shared block
+            ++first;
+        }
+        list.insert(list.end(), first, nextList.end());
+    }
+    m_lineCount = next.m_lineCount;
+}
+
+std::vector<std::uint32_t> &TrigramIndex::postings(std::uint32_t trigram) {
+    if (m_slots.empty()) {
+        rehash(1024);
+    }
+    auto slot = slotOf(trigram);
+    if (m_slots[slot] != 0) {
+        return m_postings[m_slots[slot] - 1];
+    }
+    auto index = static_cast<std::uint32_t>(m_trigrams.size());
+    m_trigrams.push_back(trigram);
+    m_postings.emplace_back();
+    m_slots[slot] = index + 1;
+    if (m_trigrams.size() * 2 > m_slots.size()) {  // keep load factor below 0.5
+        rehash(m_slots.size() * 2);
+    }
+    return m_postings[index];
+}
+
+const std::vector<std::uint32_t> *TrigramIndex::findPostings(
+    std::uint32_t trigram) const {
+    if (m_slots.empty()) {
+        return nullptr;
+    }
+    auto slot = slotOf(trigram);
+    return m_slots[slot] == 0 ? nullptr : &m_postings[m_slots[slot] - 1];
+}
+
+std::size_t TrigramIndex::slotOf(std::uint32_t trigram) const {
+    auto mask = m_slots.size() - 1;
+    auto slot = static_cast<std::size_t>(hash(trigram)) & mask;
+    while (m_slots[slot] != 0 && m_trigrams[m_slots[slot] - 1] != trigram) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void TrigramIndex::rehash(std::size_t slotCount) {
+    m_slots.assign(slotCount, 0);
+    auto mask = slotCount - 1;
+    for (std::uint32_t index = 0; index < m_trigrams.size(); index++) {
+        auto slot = static_cast<std::size_t>(hash(m_trigrams[index])) & mask;
+        while (m_slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = index + 1;
+    }
+}
@@ -0,0 +1,101 @@
+#include <Simd.h>
+#include <VisibleLines.h>
+
+#include <algorithm>
+
+VisibleLines::VisibleLines() : m_lineCount(0), m_count(0) {}
+
+void VisibleLines::reset(std::size_t lineCount, bool visible) {
+    m_lineCount = lineCount;
+    m_words.assign((lineCount + 63) / 64, visible ? ~std::uint64_t(0) : 0);
+    if (visible && lineCount % 64 != 0) {  // keep bits past the end cleared
+        m_words.back() = (std::uint64_t(1) << (lineCount % 64)) - 1;
+    }
+    updateRanks();
+}
+
+void VisibleLines::resize(std::size_t lineCount) {
+    if (lineCount < m_lineCount && lineCount % 64 != 0) {
+        m_words[lineCount >> 6] &= (std::uint64_t(1) << (lineCount % 64)) - 1;
+    }
+    m_lineCount = lineCount;
+    m_words.resize((lineCount + 63) / 64, 0);
+    updateRanks();
+}
+
+void VisibleLines::set(std::uint32_t line, bool visible) {
+    auto &word = m_words[line >> 6];
+    auto bit = std::uint64_t(1) << (line & 63);
+    if (((word & bit) != 0) == visible) {
+        return;
+    }
+    word ^= bit;
+    visible ? m_count++ : m_count--;
+}
+
+void VisibleLines::setWord(std::size_t word, std::uint64_t bits) {
+    if (word + 1 == m_words.size() && m_lineCount % 64 != 0) {
+        bits &= (std::uint64_t(1) << (m_lineCount % 64)) - 1;
+    }
+    m_words[word] = bits;
+}
+
+void VisibleLines::updateRanks() {
+    auto blocks = (m_words.size() + WordsPerBlock - 1) / WordsPerBlock;
+    m_blockRanks.resize(blocks);
+    std::size_t count = 0;
+    for (std::size_t word = 0; word < m_words.size(); word++) {
+        if (word % WordsPerBlock == 0) {
+            m_blockRanks[word / WordsPerBlock] = count;
+        }
+        count += Simd::popCount64(m_words[word]);
+    }
+    m_count = count;
+}
+
+std::uint32_t VisibleLines::lineAt(std::size_t row) const {
+    auto block = std::upper_bound(m_blockRanks.begin(), m_blockRanks.end(),
+                                  row) -
+                 m_blockRanks.begin() - 1;
+    auto remaining = row - m_blockRanks[block];
+    auto word = block * WordsPerBlock;
+    for (;; word++) {
+        auto count = static_cast<std::size_t>(Simd::popCount64(m_words[word]));
+        if (remaining < count) {
+            break;
+        }
+        remaining -= count;
+    }
+    auto bits = m_words[word];
+    for (; remaining > 0; remaining--) {
+        bits &= bits - 1;  // drop the lowest visible line
+    }
+    return static_cast<std::uint32_t>(word * 64 +
+                                      Simd::countTrailingZeros64(bits));
+}
+
+std::size_t VisibleLines::rowOf(std::uint32_t line) const {
+    auto word = static_cast<std::size_t>(line >> 6);
+    auto row = m_blockRanks[word / WordsPerBlock];
+    for (auto i = word - word % WordsPerBlock; i < word; i++) {
+        row += Simd::popCount64(m_words[i]);
+    }
+    auto below = (std::uint64_t(1) << (line & 63)) - 1;
+    return row + Simd::popCount64(m_words[word] & below);
+}
+
+bool VisibleLines::extends(const VisibleLines &other) const {
+    if (other.m_lineCount > m_lineCount) {
+        return false;
+    }
+    auto words = other.m_lineCount / 64;
+    if (!std::equal(other.m_words.begin(), other.m_words.begin() + words,
+                    m_words.begin())) {
+        return false;
+    }
+    if (other.m_lineCount % 64 == 0) {
+        return true;
+    }
+    auto below = (std::uint64_t(1) << (other.m_lineCount % 64)) - 1;
+    return (m_words[words] & below) == other.m_words[words];
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdio>
+
+// assertions of the unit tests. A failed check prints where it failed and
+// the test goes on, so one run reports every broken invariant. main returns
+// Check::result()
+namespace Check {
+// failures printed before the rest are only counted
+constexpr int MaxReported = 20;
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char* file, int line, const char* condition) {
+    if (++failures() <= MaxReported) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line,
+                     condition);
+    }
+}
+
+inline int result() {
+    if (failures() != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+}  // namespace Check
+
+#define CHECK(condition)                                 \
+    do {                                                 \
+        if (!(condition)) {                              \
+            Check::fail(__FILE__, __LINE__, #condition); \
+        }                                                \
+    } while (0)
@@ -0,0 +1,213 @@
+#include <Check.h>
+#include <LogDecompressor.h>
+#include <LogFile.h>
+#include <TestLogs.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+
+#if defined(LOGREADER_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(LOGREADER_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace {
+const char* const ArchiveName = "DecompressorTest.log.z";
+constexpr std::uint64_t FrameBytes = 1024 * 1024;
+
+void writeFile(const std::string& bytes) {
+    std::ofstream file(ArchiveName, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void appendLittleEndian32(std::string& bytes, std::uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        bytes += static_cast<char>(value >> (8 * i) & 0xff);
+    }
+}
+
+// ranges of the text read back at random, also ranges loading has passed
+void checkRanges(const LogDecompressor& decompressor, std::string_view text,
+                 std::mt19937& random, int rounds) {
+    const auto size = decompressor.size();
+    for (int round = 0; round < rounds; round++) {
+        std::uint64_t begin = random() % (size + 10);
+        std::uint64_t end = begin + random() % (3 * FrameBytes);
+        auto part = decompressor.text(begin, end);
+        begin = std::min(begin, size);
+        end = std::min(end, size);
+        CHECK(part.begin() == begin && part.end() == end);
+        CHECK(part.view(begin, end) == text.substr(begin, end - begin));
+    }
+}
+
+// decompresses the archive in chunks, checking ranges on the way and the
+// whole text at the end
+void checkArchive(const std::string& archive, const std::string& text,
+                  LogDecompressor::Format format) {
+    writeFile(archive);
+    auto compressed = std::make_shared<LogFile>(ArchiveName);
+    CHECK(compressed->open());
+    CHECK(LogDecompressor::formatOf(*compressed) == format);
+    auto decompressor = std::make_shared<LogDecompressor>(compressed);
+    std::mt19937 random(5);
+    while (!decompressor->atEnd()) {
+        const auto size = decompressor->size();
+        CHECK(decompressor->decompress(size - std::min<std::uint64_t>(
+                                                  size, random() % 100000),
+                                       3 * FrameBytes + random() % 1000));
+        checkRanges(*decompressor, text, random, 4);
+    }
+    CHECK(decompressor->size() == text.size());
+    CHECK(decompressor->consumedBytes() <= archive.size());
+    checkRanges(*decompressor, text, random, 60);
+
+    // backwards page by page, each from its restart point or stored
+    LogFile logFile(ArchiveName, decompressor);
+    CHECK(logFile.isOpen());
+    CHECK(logFile.size() == static_cast<qint64>(text.size()));
+    for (auto end = text.size(); end != 0;) {
+        const auto begin = end - std::min<std::uint64_t>(end, FrameBytes / 3);
+        CHECK(logFile.text(begin, end).view(begin, end) ==
+              std::string_view(text).substr(begin, end - begin));
+        end = begin;
+    }
+}
+
+// a damaged archive ends its text where it breaks
+void checkDamaged(const std::string& archive) {
+    writeFile(archive);
+    auto compressed = std::make_shared<LogFile>(ArchiveName);
+    CHECK(compressed->open());
+    LogDecompressor decompressor(compressed);
+    bool ok = true;
+    while (!decompressor.atEnd()) {
+        ok = decompressor.decompress(decompressor.size(), 4 * FrameBytes) &&
+             ok;
+    }
+    CHECK(!ok);
+}
+
+#if defined(LOGREADER_ZLIB)
+std::string compressGzip(std::string_view text) {
+    z_stream stream{};
+    CHECK(deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8,
+                       Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string gzip(deflateBound(&stream, text.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = static_cast<uInt>(text.size());
+    stream.next_out = reinterpret_cast<Bytef*>(gzip.data());
+    stream.avail_out = static_cast<uInt>(gzip.size());
+    CHECK(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    gzip.resize(stream.total_out);
+    deflateEnd(&stream);
+    return gzip;
+}
+
+void testGzip(const std::string& text) {
+    CHECK(LogDecompressor::isBuiltIn(LogDecompressor::Format::Gzip));
+    const auto gzip = compressGzip(text);
+    checkArchive(gzip, text, LogDecompressor::Format::Gzip);
+    // rotated logs concatenated into one file
+    const auto half = text.size() / 2;
+    checkArchive(compressGzip(std::string_view(text).substr(0, half)) +
+                     compressGzip(std::string_view(text).substr(half)),
+                 text, LogDecompressor::Format::Gzip);
+    checkDamaged(gzip.substr(0, gzip.size() / 2));
+}
+#endif
+
+#if defined(LOGREADER_ZSTD)
+std::string compressZstd(std::string_view text) {
+    std::string frame(ZSTD_compressBound(text.size()), '\0');
+    const auto size = ZSTD_compress(frame.data(), frame.size(), text.data(),
+                                    text.size(), 3);
+    CHECK(!ZSTD_isError(size));
+    frame.resize(size);
+    return frame;
+}
+
+std::string skippableFrame(std::uint32_t size) {
+    std::string frame;
+    appendLittleEndian32(frame, 0x184d2a53u);
+    appendLittleEndian32(frame, size);
+    return frame + std::string(size, 'x');
+}
+
+// frames of FrameBytes, with a seek table or skippable frames in between
+std::string compressZstdFrames(std::string_view text, bool seekTable,
+                               bool skippable) {
+    std::string archive;
+    std::string table;
+    std::uint32_t frames = 0;
+    for (std::uint64_t begin = 0; begin < text.size(); begin += FrameBytes) {
+        auto frame = compressZstd(text.substr(begin, FrameBytes));
+        if (skippable && frames % 3 == 1) {
+            frame = skippableFrame(frames) + frame;
+        }
+        const auto frameText = std::min(FrameBytes, text.size() - begin);
+        appendLittleEndian32(table, static_cast<std::uint32_t>(frame.size()));
+        appendLittleEndian32(table, static_cast<std::uint32_t>(frameText));
+        archive += frame;
+        frames++;
+    }
+    if (seekTable) {
+        appendLittleEndian32(archive, 0x184d2a5eu);
+        appendLittleEndian32(archive,
+                             static_cast<std::uint32_t>(table.size() + 9));
+        archive += table;
+        appendLittleEndian32(archive, frames);
+        archive += '\0';
+        appendLittleEndian32(archive, 0x8f92eab1u);
+    }
+    return archive;
+}
+
+void testZstd(const std::string& text) {
+    CHECK(LogDecompressor::isBuiltIn(LogDecompressor::Format::Zstd));
+    // one frame, far from any restart point
+    const auto zstd = compressZstd(text);
+    checkArchive(zstd, text, LogDecompressor::Format::Zstd);
+    checkArchive(compressZstdFrames(text, false, false), text,
+                 LogDecompressor::Format::Zstd);
+    checkArchive(compressZstdFrames(text, false, true), text,
+                 LogDecompressor::Format::Zstd);
+    // restart points from the seek table, also around skippable frames
+    checkArchive(compressZstdFrames(text, true, false), text,
+                 LogDecompressor::Format::Zstd);
+    checkArchive(compressZstdFrames(text, true, true), text,
+                 LogDecompressor::Format::Zstd);
+    // a seek table that does not match its frames is ignored
+    auto wrongTable = compressZstdFrames(text, true, false);
+    wrongTable[wrongTable.size() - 17] ^= 1;  // compressed size of the last
+    checkArchive(wrongTable, text, LogDecompressor::Format::Zstd);
+    checkArchive(skippableFrame(100) + compressZstd(text), text,
+                 LogDecompressor::Format::Zstd);
+    checkDamaged(zstd.substr(0, zstd.size() / 2));
+}
+#endif
+}  // namespace
+
+int main() {
+    // longer than the text a restart point may stand for
+    std::string text;
+    for (std::uint32_t seed = 0; text.size() < 20 * FrameBytes; seed++) {
+        text += makeTestLog(seed, 20000);
+    }
+    CHECK(LogDecompressor::isBuiltIn(LogDecompressor::Format::None));
+#if defined(LOGREADER_ZLIB)
+    testGzip(text);
+#endif
+#if defined(LOGREADER_ZSTD)
+    testZstd(text);
+#endif
+    std::remove(ArchiveName);
+    return Check::result();
+}
@@ -0,0 +1,347 @@
+#include <Check.h>
+#include <LogFilter.h>
+#include <ParallelLogParser.h>
+#include <TemplateMiner.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+#include <TimeIndex.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+// the filter state spelled out, evaluated record by record from scratch
+struct ExpectedFilter {
+    std::uint8_t levelMask = 0x3f;
+    std::set<std::uint32_t> uncheckedClasses;
+    std::set<std::uint32_t> uncheckedTemplates;
+    const std::vector<std::uint64_t>* matches = nullptr;
+    bool timeRange = false;
+    std::int64_t from = 0;
+    std::int64_t to = 0;
+
+    bool isVisible(const LogTable& table, std::size_t record) const {
+        auto header = table.recordBegin(record);
+        auto level = table.levels[header];
+        auto classId = table.classIds[header];
+        // lines before the first header are shown under any levels and
+        // times
+        if ((level != LogTable::NoLevel && ((levelMask >> level) & 1) == 0) ||
+            uncheckedClasses.count(classId) != 0 ||
+            uncheckedTemplates.count(table.templateIds[record]) != 0) {
+            return false;
+        }
+        if (timeRange && level != LogTable::NoLevel &&
+            (table.timestamps[header] < from ||
+             table.timestamps[header] > to)) {
+            return false;
+        }
+        if (matches == nullptr) {
+            return true;
+        }
+        for (auto line = header; line < table.recordEnd(record); line++) {
+            if (((*matches)[line >> 6] >> (line & 63)) & 1) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+void setChecked(std::set<std::uint32_t>& unchecked, std::uint32_t id,
+                bool checked) {
+    if (checked) {
+        unchecked.erase(id);
+    } else {
+        unchecked.insert(id);
+    }
+}
+
+// the visible lines of the incrementally updated filter are the lines of
+// the records a fresh evaluation shows, with a consistent rank directory
+void checkVisible(const LogFilter& filter, const ExpectedFilter& expected,
+                  const LogTable& table) {
+    const auto& visible = filter.visibleLines();
+    CHECK(visible.lineCount() == table.size());
+    std::size_t count = 0;
+    for (std::size_t record = 0; record < table.recordCount(); record++) {
+        auto shown = expected.isVisible(table, record);
+        for (auto line = table.recordBegin(record);
+             line < table.recordEnd(record); line++) {
+            CHECK(visible.contains(line) == shown);
+            if (shown) {
+                CHECK(visible.rowOf(line) == count);
+                CHECK(visible.lineAt(count) == line);
+                count++;
+            }
+        }
+    }
+    CHECK(visible.size() == count);
+}
+
+// a line shown or hidden above the end breaks the rows of the shorter set
+void testExtends() {
+    VisibleLines shorter;
+    shorter.reset(130, true);
+    VisibleLines longer;
+    longer.reset(200, false);
+    for (std::uint32_t line = 0; line < 130; line++) {
+        longer.set(line, true);
+    }
+    longer.set(150, true);
+    longer.updateRanks();
+    CHECK(longer.extends(shorter));
+    CHECK(!shorter.extends(longer));
+    longer.set(129, false);
+    CHECK(!longer.extends(shorter));
+    longer.set(129, true);
+    shorter.set(3, false);
+    CHECK(!longer.extends(shorter));
+}
+
+// loads a log chunk by chunk and toggles checkboxes, the search and the
+// time range in between, comparing with a fresh evaluation after each step
+void testIncrementalFilter(const std::string& text, std::uint32_t seed) {
+    std::mt19937 random(seed);
+    ThreadPool pool(3);
+    ParallelLogParser parser(pool);
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    TemplateMiner miner;
+    TimeIndex timeIndex;
+    LogFilter filter;
+    ExpectedFilter expected;
+    std::vector<std::uint64_t> matches;
+
+    std::uint64_t end = 0;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 400000 + 1);
+        const auto firstLine = table.size();
+        auto loaded = textPart(text, lineIndex.indexedSize(), end);
+        parser.parse(loaded, end == text.size(), lineIndex, table, counts);
+        // a search only adds the matches of the new lines
+        matches.resize((table.size() + 63) / 64, 0);
+        for (auto line = firstLine; line < table.size(); line++) {
+            if (random() % 40 == 0) {
+                matches[line >> 6] |= std::uint64_t(1) << (line & 63);
+            }
+        }
+        miner.index(loaded, table);
+        timeIndex.index(table);
+        auto previous = filter.visibleLines();
+        filter.index(table);
+        checkVisible(filter, expected, table);
+        // new lines only append rows under a filter that did not change
+        CHECK(filter.visibleLines().extends(previous));
+
+        for (int toggle = 0; toggle < 8; toggle++) {
+            auto checked = random() % 2 == 0;
+            switch (random() % 9) {
+                case 0: {
+                    auto level = random() % LogLevelCount;
+                    filter.setLevelChecked(static_cast<LogLevel>(level),
+                                           checked);
+                    expected.levelMask =
+                        checked ? expected.levelMask | 1u << level
+                                : expected.levelMask & ~(1u << level);
+                    break;
+                }
+                case 1:
+                    filter.setAllLevelsChecked(checked);
+                    expected.levelMask = checked ? 0x3f : 0;
+                    break;
+                case 2: {
+                    auto classId = static_cast<std::uint32_t>(
+                        random() % (table.classes.size() + 1));
+                    filter.setClassChecked(classId, checked);
+                    if (classId < table.classes.size()) {
+                        setChecked(expected.uncheckedClasses, classId,
+                                   checked);
+                    }
+                    break;
+                }
+                case 3:
+                    filter.setAllClassesChecked(checked);
+                    expected.uncheckedClasses.clear();
+                    for (std::uint32_t id = 0;
+                         !checked && id < table.classes.size(); id++) {
+                        expected.uncheckedClasses.insert(id);
+                    }
+                    break;
+                case 4: {
+                    if (miner.size() == 0) {
+                        break;
+                    }
+                    auto templateId =
+                        static_cast<std::uint32_t>(random() % miner.size());
+                    filter.setTemplateChecked(templateId, checked);
+                    setChecked(expected.uncheckedTemplates, templateId,
+                               checked);
+                    break;
+                }
+                case 5:
+                    filter.setAllTemplatesChecked(checked);
+                    expected.uncheckedTemplates.clear();
+                    for (std::uint32_t id = 0; !checked && id < miner.size();
+                         id++) {
+                        expected.uncheckedTemplates.insert(id);
+                    }
+                    break;
+                case 6:
+                    filter.setLineMatches(checked ? &matches : nullptr);
+                    expected.matches = checked ? &matches : nullptr;
+                    break;
+                case 7: {
+                    auto from = timeIndex.minimum() +
+                                static_cast<std::int64_t>(random() % 60) *
+                                    1000000;
+                    auto to = from + static_cast<std::int64_t>(
+                                         random() % 600) * 1000000;
+                    filter.setTimeRange(checked ? &timeIndex : nullptr, from,
+                                        to);
+                    expected.timeRange = checked;
+                    expected.from = from;
+                    expected.to = to;
+                    break;
+                }
+                default:
+                    // a toggle that changes nothing
+                    filter.setLevelChecked(
+                        LogLevel::INFO, (expected.levelMask >> 2) & 1);
+                    break;
+            }
+            checkVisible(filter, expected, table);
+        }
+    }
+}
+
+// a log loaded up to a last line without line ending, which is taken back
+// and parsed again with the text written after it, ends up like a log
+// loaded at once
+void testReopenedLastLine(const std::string& text, std::uint32_t seed) {
+    std::mt19937 random(seed);
+    ThreadPool pool(2);
+    ParallelLogParser parser(pool);
+    LineIndex wholeIndex;
+    LogTable whole;
+    LevelCounts wholeCounts{};
+    parser.parse(LogText(text), true, wholeIndex, whole, wholeCounts);
+
+    for (int round = 0; round < 40; round++) {
+        auto cut = random() % (text.size() - 1) + 1;
+        while (cut > 1 && text[cut - 1] == '\n') {
+            cut--;
+        }
+        LineIndex lineIndex;
+        LogTable table;
+        LevelCounts counts{};
+        TemplateMiner miner;
+        TimeIndex timeIndex;
+        LogFilter filter;
+        ExpectedFilter expected;
+        auto loaded = textPart(text, 0, cut);
+        parser.parse(loaded, true, lineIndex, table, counts);
+        miner.index(loaded, table);
+        timeIndex.index(table);
+        filter.index(table);
+        filter.setLevelChecked(LogLevel::INFO, false);
+        expected.levelMask &= ~(1u << 2);
+        if (miner.size() != 0) {
+            filter.setTemplateChecked(0, false);
+            expected.uncheckedTemplates.insert(0);
+        }
+        CHECK(lineIndex.endsWithPartialLine());
+
+        // what the processor does when following is turned on
+        const auto line = lineIndex.lineCount() - 1;
+        const auto record = table.recordOf(line);
+        const auto records =
+            table.recordBegin(record) == line ? record : record + 1;
+        LevelCounts dropped{};
+        table.countLevels(line, dropped);
+        for (std::size_t level = 0; level < LogLevelCount; level++) {
+            counts[level] -= dropped[level];
+        }
+        miner.forget(table, records);
+        table.truncate(line);
+        lineIndex.truncate(line);
+        filter.truncate(table);
+        filter.index(table);
+        timeIndex.index(table);
+        CHECK(table.size() == line && lineIndex.lineCount() == line);
+        CHECK(!lineIndex.endsWithPartialLine());
+        checkVisible(filter, expected, table);
+
+        loaded = textPart(text, lineIndex.indexedSize(), text.size());
+        parser.parse(loaded, true, lineIndex, table, counts);
+        miner.index(loaded, table);
+        timeIndex.index(table);
+        filter.index(table);
+        checkVisible(filter, expected, table);
+
+        CHECK(lineIndex.lineCount() == wholeIndex.lineCount());
+        for (std::size_t i = 0; i <= wholeIndex.lineCount(); i++) {
+            CHECK(lineIndex.lineBegin(i) == wholeIndex.lineBegin(i));
+        }
+        CHECK(counts == wholeCounts);
+        CHECK(table.size() == whole.size());
+        CHECK(table.recordCount() == whole.recordCount());
+        for (std::size_t row = 0; row < whole.size(); row++) {
+            CHECK(table.levels[row] == whole.levels[row] &&
+                  table.classIds[row] == whole.classIds[row] &&
+                  table.timestamps[row] == whole.timestamps[row] &&
+                  table.messageOffsets[row] == whole.messageOffsets[row] &&
+                  table.messageLengths[row] == whole.messageLengths[row]);
+        }
+        TimeIndex wholeTimes;
+        wholeTimes.index(whole);
+        CHECK(timeIndex.minimum() == wholeTimes.minimum());
+        CHECK(timeIndex.maximum() == wholeTimes.maximum());
+        // every template counts the records that have it
+        std::vector<std::uint64_t> templateCounts(miner.size(), 0);
+        for (std::size_t i = 0; i < table.templateIds.size(); i++) {
+            if (table.templateIds[i] != LogTable::NoTemplate) {
+                templateCounts[table.templateIds[i]]++;
+            }
+        }
+        CHECK(table.templateIds.size() == table.recordCount());
+        for (std::uint32_t id = 0; id < miner.size(); id++) {
+            CHECK(miner.at(id).count == templateCounts[id]);
+        }
+    }
+}
+
+// a log without spdlog headers is a single record that no level hides
+void testHeaderlessLog() {
+    const std::string text = "plain text\nwithout\r\nheaders";
+    ThreadPool pool(1);
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    ParallelLogParser(pool).parse(LogText(text), true, lineIndex, table,
+                                  counts);
+    LogFilter filter;
+    filter.index(table);
+    CHECK(table.recordCount() == 1);
+    CHECK(filter.visibleLines().size() == 3);
+    filter.setAllLevelsChecked(false);
+    CHECK(filter.visibleLines().size() == 3);
+    filter.setLevelChecked(LogLevel::ERROR, true);
+    filter.setLevelChecked(LogLevel::ERROR, false);
+    filter.setAllClassesChecked(false);
+    CHECK(filter.visibleLines().size() == 3);
+}
+}  // namespace
+
+int main() {
+    testExtends();
+    testHeaderlessLog();
+    testIncrementalFilter(makeTestLog(5, 60000), 6);
+    testIncrementalFilter(makeTestLog(8, 20000, true), 9);
+    testReopenedLastLine(makeTestLog(3, 300, true), 4);
+    return Check::result();
+}
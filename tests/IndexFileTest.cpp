@@ -0,0 +1,291 @@
+#include <Check.h>
+#include <IndexFile.h>
+#include <LogFilter.h>
+#include <ParallelLogParser.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+#include <TimeIndex.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+const char* const LogFileName = "IndexFileTest.log";
+
+template <typename Column>
+bool equalColumns(const Column& a, const Column& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+void writeFile(const std::string& fileName, const std::string& bytes) {
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::string readFile(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+}
+
+// what a part saves, loaded again from memory. Returns whether the reader
+// accepted it
+bool reload(const std::function<void(IndexWriter&)>& save,
+            const std::function<void(IndexReader&)>& load) {
+    auto bytes = std::make_shared<std::string>();
+    IndexWriter writer([&bytes](const char* data, std::size_t size) {
+        bytes->append(data, size);
+        return true;
+    });
+    save(writer);
+    IndexReader reader(bytes->data(), bytes->size(), bytes);
+    load(reader);
+    return reader.ok();
+}
+
+// everything LogTextProcessor keeps of a log
+struct Indexes {
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    TrigramIndex trigramIndex;
+    TemplateMiner miner;
+
+    // indexes the log up to end as loading does, after what a sidecar held
+    void index(const LogFile& logFile, std::uint64_t end, ThreadPool& pool) {
+        auto loaded = logFile.text(lineIndex.indexedSize(), end);
+        ParallelLogParser(pool).parse(loaded,
+                                      end == std::uint64_t(logFile.size()),
+                                      lineIndex, table, counts);
+        // a damaged sidecar may hold fewer lines of the trigram index
+        trigramIndex.index(
+            logFile.text(lineIndex.lineBegin(trigramIndex.lineCount()), end),
+            lineIndex, pool);
+        miner.index(loaded, table);
+    }
+    std::uint64_t load(const LogFile& logFile) {
+        return IndexFile(LogFileName)
+            .load(logFile, lineIndex, table, counts, &trigramIndex, miner);
+    }
+    bool save(const LogFile& logFile) const {
+        return IndexFile(LogFileName)
+            .save(logFile, lineIndex, table, counts, &trigramIndex, miner);
+    }
+    bool isEmpty() const {
+        return lineIndex.lineCount() == 0 && table.size() == 0 &&
+               trigramIndex.lineCount() == 0 && miner.size() == 0;
+    }
+};
+
+void checkEqual(const Indexes& a, const Indexes& b) {
+    CHECK(a.lineIndex.lineCount() == b.lineIndex.lineCount());
+    CHECK(a.lineIndex.indexedSize() == b.lineIndex.indexedSize());
+    CHECK(equalColumns(a.table.timestamps, b.table.timestamps));
+    CHECK(equalColumns(a.table.levels, b.table.levels));
+    CHECK(equalColumns(a.table.classIds, b.table.classIds));
+    CHECK(equalColumns(a.table.messageOffsets, b.table.messageOffsets));
+    CHECK(equalColumns(a.table.messageLengths, b.table.messageLengths));
+    CHECK(equalColumns(a.table.records, b.table.records));
+    CHECK(equalColumns(a.table.templateIds, b.table.templateIds));
+    CHECK(a.counts == b.counts);
+    CHECK(a.trigramIndex.lineCount() == b.trigramIndex.lineCount());
+    for (auto literal : {"probe_id", "connected", "-- st", "zzz"}) {
+        CHECK(a.trigramIndex.candidateBlocks(literal) ==
+              b.trigramIndex.candidateBlocks(literal));
+    }
+    CHECK(a.miner.size() == b.miner.size());
+    for (std::uint32_t id = 0; id < a.miner.size() && id < b.miner.size();
+         id++) {
+        CHECK(a.miner.text(id) == b.miner.text(id));
+        CHECK(a.miner.at(id).count == b.miner.at(id).count);
+    }
+}
+
+// a sidecar of the first part of a log, loading it and indexing the rest
+// gives the indexes of the whole log
+void testRoundTrip(const LogFile& logFile, std::uint64_t savedEnd,
+                   ThreadPool& pool) {
+    Indexes expected;
+    expected.index(logFile, logFile.size(), pool);
+
+    Indexes saved;
+    saved.index(logFile, savedEnd, pool);
+    CHECK(saved.save(logFile));
+
+    Indexes loaded;
+    CHECK(loaded.load(logFile) == saved.lineIndex.indexedSize());
+    checkEqual(loaded, saved);
+    loaded.index(logFile, logFile.size(), pool);
+    checkEqual(loaded, expected);
+}
+
+// a sidecar cut off anywhere is rejected and leaves everything empty
+void testTruncated(const LogFile& logFile, const std::string& sidecar) {
+    for (auto size : {std::size_t(0), std::size_t(7), std::size_t(64),
+                      sidecar.size() / 3, sidecar.size() / 2,
+                      sidecar.size() - 8, sidecar.size() - 1}) {
+        writeFile(IndexFile(LogFileName).fileName().toStdString(),
+                  sidecar.substr(0, size));
+        Indexes loaded;
+        CHECK(loaded.load(logFile) == 0);
+        CHECK(loaded.isEmpty());
+    }
+}
+
+// flipped bytes either fail the sidecar or leave indexes that loading the
+// rest of the log, filtering and searching can use
+void testCorrupted(const LogFile& logFile, const std::string& sidecar,
+                   ThreadPool& pool) {
+    std::mt19937 random(21);
+    const auto fileName = IndexFile(LogFileName).fileName().toStdString();
+    std::size_t rejected = 0;
+    for (int round = 0; round < 300; round++) {
+        auto damaged = sidecar;
+        for (auto flips = random() % 4 + 1; flips > 0; flips--) {
+            damaged[random() % damaged.size()] ^=
+                static_cast<char>(1u << (random() % 8));
+        }
+        writeFile(fileName, damaged);
+        Indexes loaded;
+        auto loadedSize = loaded.load(logFile);
+        if (loadedSize == 0) {
+            CHECK(loaded.isEmpty());
+            rejected++;
+            continue;
+        }
+        CHECK(loaded.lineIndex.lineCount() == loaded.table.size());
+        loaded.index(logFile, logFile.size(), pool);
+        LogFilter filter;
+        filter.index(loaded.table);
+        filter.setTemplateChecked(0, false);
+        filter.setClassChecked(0, false);
+        TimeIndex timeIndex;
+        timeIndex.index(loaded.table);
+        loaded.trigramIndex.candidateBlocks("probe_id");
+    }
+    CHECK(rejected > 0);
+}
+
+// parts fail the reader on ids and offsets that would be used out of range
+void testDamagedParts(const LogFile& logFile, ThreadPool& pool) {
+    Indexes indexes;
+    indexes.index(logFile, logFile.size(), pool);
+    const auto textSize = indexes.lineIndex.indexedSize();
+    auto loadTable = [&](const LogTable& table) {
+        return reload([&](IndexWriter& writer) { table.save(writer); },
+                      [&](IndexReader& reader) {
+                          LogTable().load(reader, textSize);
+                      });
+    };
+    CHECK(loadTable(indexes.table));
+    auto table = indexes.table;
+    table.levels.set(10, LogLevelCount);
+    CHECK(!loadTable(table));
+    table = indexes.table;
+    table.classIds.set(10, table.classes.size());
+    CHECK(!loadTable(table));
+    table = indexes.table;
+    table.records.set(2, table.records[1]);
+    CHECK(!loadTable(table));
+    table = indexes.table;
+    table.records.set(table.recordCount() - 1, table.size());
+    CHECK(!loadTable(table));
+    table = indexes.table;
+    table.messageOffsets.set(10, textSize - 1);
+    CHECK(!loadTable(table));
+
+    auto loadLines = [](std::vector<std::uint64_t> offsets) {
+        return reload(
+            [&](IndexWriter& writer) {
+                writer.writeArray(offsets.data(), offsets.size());
+                writer.write<std::uint8_t>(0);
+            },
+            [](IndexReader& reader) { LineIndex().load(reader); });
+    };
+    CHECK(loadLines({0, 5, 9}));
+    CHECK(!loadLines({0, 5, 5, 9}));
+    CHECK(!loadLines({0, 9, 5}));
+    CHECK(!loadLines({3, 5}));
+
+    // 100 lines are 2 blocks
+    auto loadTrigrams = [](std::vector<std::uint32_t> blocks) {
+        return reload(
+            [&](IndexWriter& writer) {
+                std::uint32_t trigram = 0x616263;
+                writer.write<std::uint64_t>(100);
+                writer.writeArray(&trigram, 1);
+                writer.writeArray(blocks.data(), blocks.size());
+            },
+            [](IndexReader& reader) { TrigramIndex().load(reader); });
+    };
+    CHECK(loadTrigrams({0, 1}));
+    CHECK(!loadTrigrams({0, 2}));
+    CHECK(!loadTrigrams({1, 0}));
+
+    // a group of one token messages with a single template at its root
+    auto loadMiner = [](std::uint32_t token, std::uint32_t templateId,
+                        std::uint64_t groupLength) {
+        return reload(
+            [&](IndexWriter& writer) {
+                writer.write<std::uint64_t>(1);
+                writer.writeString("<*>");
+                writer.write<std::uint64_t>(1);
+                writer.write<std::uint32_t>(LogTable::NoClass);
+                writer.writeArray(&token, 1);
+                writer.write<std::uint64_t>(1);
+                writer.write<std::int64_t>(0);
+                writer.write<std::int64_t>(0);
+                writer.write<std::uint64_t>(1);
+                writer.write<std::uint32_t>(0);
+                writer.writeArray(&templateId, 1);
+                writer.write<std::uint64_t>(0);
+                writer.write<std::uint64_t>(1);
+                writer.write<std::uint64_t>(
+                    std::uint64_t(LogTable::NoClass) << 32 | groupLength);
+                writer.write<std::uint32_t>(0);
+            },
+            [](IndexReader& reader) { TemplateMiner().load(reader); });
+    };
+    CHECK(loadMiner(0, 0, 1));
+    CHECK(!loadMiner(1, 0, 1));
+    CHECK(!loadMiner(0, 1, 1));
+    CHECK(!loadMiner(0, 0, 2));
+
+    // a record template the miner does not have
+    auto damaged = indexes;
+    damaged.table.templateIds.set(0, damaged.miner.size());
+    CHECK(damaged.save(logFile));
+    Indexes loaded;
+    CHECK(loaded.load(logFile) == 0);
+    CHECK(loaded.isEmpty());
+}
+}  // namespace
+
+int main() {
+    writeFile(LogFileName, makeTestLog(17, 30000, true));
+    LogFile logFile(LogFileName);
+    CHECK(logFile.open());
+    ThreadPool pool(3);
+
+    testRoundTrip(logFile, logFile.size() / 2, pool);
+    testRoundTrip(logFile, logFile.size(), pool);
+    const auto sidecarName = IndexFile(LogFileName).fileName().toStdString();
+    Indexes saved;
+    saved.index(logFile, logFile.size() / 3, pool);
+    CHECK(saved.save(logFile));
+    const auto sidecar = readFile(sidecarName);
+    CHECK(!sidecar.empty());
+    testTruncated(logFile, sidecar);
+    testCorrupted(logFile, sidecar, pool);
+    testDamagedParts(logFile, pool);
+
+    logFile.close();
+    std::remove(sidecarName.c_str());
+    std::remove(LogFileName);
+    return Check::result();
+}
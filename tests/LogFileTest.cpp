@@ -0,0 +1,78 @@
+#include <Check.h>
+#include <LogFile.h>
+#include <TestLogs.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+const char* const LogFileName = "LogFileTest.log";
+
+void writeFile(const std::string& bytes) {
+    std::ofstream file(LogFileName, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// any range reads the bytes of the file, clipped to its size
+void testRanges(const std::string& text, LogFile::Access access) {
+    LogFile logFile(LogFileName, access);
+    CHECK(logFile.open());
+    CHECK(logFile.access() == access);
+    CHECK(logFile.size() == static_cast<qint64>(text.size()));
+    std::mt19937 random(3);
+    for (int round = 0; round < 200; round++) {
+        std::uint64_t begin = random() % (text.size() + 10);
+        std::uint64_t end = begin + random() % 20000000;
+        auto part = logFile.text(begin, end);
+        begin = std::min<std::uint64_t>(begin, text.size());
+        end = std::min<std::uint64_t>(end, text.size());
+        CHECK(part.begin() == begin && part.end() == end);
+        CHECK(part.view(begin, end) == std::string_view(text).substr(
+                                           begin, end - begin));
+    }
+    CHECK(!logFile.isTruncated());
+}
+
+// a read log truncated in place while it is open reads zeros where a
+// mapping would raise SIGBUS, until it is opened again
+void testTruncatedInPlace(const std::string& text) {
+    LogFile logFile(LogFileName, LogFile::Access::Read);
+    CHECK(logFile.open());
+    const auto kept = text.size() / 3;
+    writeFile(text.substr(0, kept));
+
+    auto head = logFile.text(0, kept);
+    CHECK(head.view(0, kept) == std::string_view(text).substr(0, kept));
+    CHECK(!logFile.isTruncated());
+    auto all = logFile.text(kept - 100, text.size());
+    CHECK(all.end() == text.size());
+    CHECK(all.view(kept - 100, kept) ==
+          std::string_view(text).substr(kept - 100, 100));
+    CHECK(all.view(kept, text.size()).find_first_not_of('\0') ==
+          std::string_view::npos);
+    CHECK(logFile.isTruncated());
+
+    LogFile reopened(LogFileName, LogFile::Access::Read);
+    CHECK(reopened.open());
+    CHECK(reopened.size() == static_cast<qint64>(kept));
+    CHECK(!reopened.isTruncated());
+}
+}  // namespace
+
+int main() {
+    // a few read pieces long
+    std::string text;
+    for (std::uint32_t seed = 0; text.size() < 10 * 1024 * 1024; seed++) {
+        text += makeTestLog(seed, 20000);
+    }
+    writeFile(text);
+    testRanges(text, LogFile::Access::Mapped);
+    testRanges(text, LogFile::Access::Read);
+    testTruncatedInPlace(text);
+    std::remove(LogFileName);
+    return Check::result();
+}
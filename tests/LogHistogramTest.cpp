@@ -0,0 +1,105 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LogHistogram.h>
+#include <LogTable.h>
+#include <ParallelLogParser.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// the base buckets count the record headers of every level by their time,
+// records before the first one in the first bucket, and every coarser
+// level sums two buckets of the level below
+void checkHistogram(const LogHistogram& histogram, const LogTable& table,
+                    const LevelCounts& levelCounts) {
+    CHECK(histogram.rowCount() == table.size());
+    const auto width = histogram.bucketWidth(0);
+    std::vector<LogHistogram::Counts> expected;
+    for (std::size_t row = 0; row < table.size(); row++) {
+        if (table.levels[row] == LogTable::NoLevel) {
+            continue;
+        }
+        const auto offset =
+            std::max<std::int64_t>(0, table.timestamps[row] -
+                                          histogram.begin());
+        const auto bucket = static_cast<std::size_t>(offset / width);
+        if (bucket >= expected.size()) {
+            expected.resize(bucket + 1, LogHistogram::Counts());
+        }
+        expected[bucket][table.levels[row]]++;
+    }
+    CHECK(histogram.buckets(0) == expected);
+    CHECK(expected.size() <= LogHistogram::MaxBuckets);
+    CHECK(histogram.empty() == expected.empty());
+    CHECK(histogram.end() - histogram.begin() ==
+          static_cast<std::int64_t>(expected.size()) * width);
+
+    LogHistogram::Counts total{};
+    for (const auto& counts : expected) {
+        for (std::size_t level = 0; level < LogLevelCount; level++) {
+            total[level] += counts[level];
+        }
+    }
+    for (std::size_t level = 0; level < LogLevelCount; level++) {
+        CHECK(total[level] == levelCounts[level]);
+    }
+
+    for (std::size_t level = 1; level < histogram.levelCount(); level++) {
+        const auto& below = histogram.buckets(level - 1);
+        const auto& buckets = histogram.buckets(level);
+        CHECK(histogram.bucketWidth(level) == 2 * histogram.bucketWidth(
+                                                      level - 1));
+        CHECK(buckets.size() == (below.size() + 1) / 2);
+        for (std::size_t bucket = 0; bucket < buckets.size(); bucket++) {
+            auto sum = below[2 * bucket];
+            for (std::size_t i = 0; 2 * bucket + 1 < below.size() &&
+                                    i < LogLevelCount;
+                 i++) {
+                sum[i] += below[2 * bucket + 1][i];
+            }
+            CHECK(buckets[bucket] == sum);
+        }
+    }
+    // the coarsest level is a single bucket
+    CHECK(histogram.buckets(histogram.levelCount() - 1).size() <= 1);
+    for (std::size_t level = 0; level < histogram.levelCount(); level++) {
+        CHECK(histogram.levelFor(histogram.bucketWidth(level)) == level);
+    }
+}
+
+// counts a log loaded in chunks, checking after every chunk
+void testIncremental(const std::string& text, std::uint32_t seed) {
+    std::mt19937 random(seed);
+    ThreadPool pool(2);
+    ParallelLogParser parser(pool);
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    LogHistogram histogram;
+    std::uint64_t end = 0;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 300000 + 1);
+        parser.parse(textPart(text, lineIndex.indexedSize(), end),
+                     end == text.size(), lineIndex, table, counts);
+        histogram.index(table);
+        checkHistogram(histogram, table, counts);
+    }
+}
+}  // namespace
+
+int main() {
+    // a few minutes of records, more one millisecond buckets than fit
+    testIncremental(makeTestLog(1, 20000), 1);
+    testIncremental(makeTestLog(2, 5000, true), 2);
+    LogHistogram empty;
+    empty.index(LogTable());
+    CHECK(empty.empty() && empty.levelCount() == 1);
+    return Check::result();
+}
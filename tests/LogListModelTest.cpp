@@ -0,0 +1,182 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LogDocument.h>
+#include <LogFile.h>
+#include <LogFilter.h>
+#include <LogListModel.h>
+#include <LogTable.h>
+#include <ParallelLogParser.h>
+#include <RepeatFolder.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+#include <TimeIndex.h>
+#include <VisibleLines.h>
+
+#include <QPersistentModelIndex>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+const char* const LogFileName = "LogListModelTest.log";
+
+// every row is its visible line, with the text, level, class and repeat
+// run of that line
+void checkRows(const LogListModel& model, const LogDocument& document,
+               const VisibleLines& lines, const RepeatRuns* runs) {
+    CHECK(model.rowCount() == static_cast<int>(lines.size()));
+    const auto& table = document.table();
+    for (int row = 0; row < model.rowCount(); row++) {
+        const auto line = lines.lineAt(static_cast<std::size_t>(row));
+        const auto index = model.index(row);
+        CHECK(model.lineAt(row) == line);
+        CHECK(model.rowOf(line) == row);
+        CHECK(index.data(LogListModel::LineRole).toUInt() == line);
+        const auto text = document.line(line);
+        CHECK(index.data(Qt::DisplayRole).toString() ==
+              QString::fromUtf8(text.data(), text.size()));
+        const auto level = index.data(LogListModel::LevelRole);
+        CHECK(level.isValid() == (table.levels[line] != LogTable::NoLevel));
+        CHECK(!level.isValid() || level.toInt() == table.levels[line]);
+        const auto classId = index.data(LogListModel::ClassRole);
+        CHECK(classId.isValid() == (table.classIds[line] != LogTable::NoClass));
+        CHECK(!classId.isValid() || classId.toUInt() == table.classIds[line]);
+
+        const RepeatRun* run = nullptr;
+        for (std::size_t i = 0; runs != nullptr && i < runs->size(); i++) {
+            if ((*runs)[i].line == line) {
+                run = &(*runs)[i];
+            }
+        }
+        const auto count = index.data(LogListModel::RepeatCountRole);
+        CHECK(count.isValid() == (run != nullptr));
+        if (run != nullptr && count.isValid()) {
+            CHECK(count.toUInt() == run->count);
+            CHECK(index.data(LogListModel::RepeatEndRole).toLongLong() ==
+                  table.timestamps[run->lastLine]);
+            CHECK(index.data(LogListModel::RepeatExpandedRole).toBool() ==
+                  run->expanded);
+        }
+    }
+}
+
+// loads the log in chunks, publishing a document of one generation after
+// every chunk as the processor does, then filters and folds the shown
+// document and starts a new generation
+void testModel(const std::string& text) {
+    {
+        std::ofstream file(LogFileName, std::ios::binary | std::ios::trunc);
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    auto logFile = std::make_shared<LogFile>(LogFileName);
+    CHECK(logFile->open());
+    std::mt19937 random(7);
+    ThreadPool pool(2);
+    ParallelLogParser parser(pool);
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    TimeIndex timeIndex;
+    LogFilter filter;
+    filter.setLevelChecked(LogLevel::INFO, false);
+    LogListModel model;
+    std::shared_ptr<const LogDocument> document;
+
+    std::unique_ptr<QPersistentModelIndex> kept;
+    std::uint32_t keptLine = 0;
+    std::uint64_t end = 0;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 30000 + 1);
+        parser.parse(logFile->text(lineIndex.indexedSize(), end),
+                     end == text.size(), lineIndex, table, counts);
+        timeIndex.index(table);
+        filter.index(table);
+        document = std::make_shared<const LogDocument>(
+            logFile, logFile, 1, lineIndex, table, timeIndex,
+            end == text.size());
+        auto lines = std::make_shared<const VisibleLines>(
+            filter.visibleLines());
+        model.setLogDocument(document, lines, nullptr);
+        CHECK(model.document() == document);
+        checkRows(model, *document, *lines, nullptr);
+        // rows appended behind a row leave it where it was
+        if (kept != nullptr) {
+            CHECK(kept->isValid() && model.lineAt(kept->row()) == keptLine);
+        } else if (model.rowCount() > 10) {
+            kept = std::make_unique<QPersistentModelIndex>(model.index(10));
+            keptLine = model.lineAt(10);
+        }
+    }
+    CHECK(kept != nullptr);
+
+    // hiding the kept line moves its row to the next visible line
+    const auto header = table.recordBegin(table.recordOf(keptLine));
+    if (table.classIds[header] != LogTable::NoClass) {
+        filter.setClassChecked(table.classIds[header], false);
+    } else {
+        filter.setAllLevelsChecked(false);
+    }
+    auto lines = std::make_shared<const VisibleLines>(filter.visibleLines());
+    model.setFilteredLines(document, lines, nullptr);
+    checkRows(model, *document, *lines, nullptr);
+    auto next = keptLine;
+    while (next < lines->lineCount() && !lines->contains(next)) {
+        next++;
+    }
+    if (next < lines->lineCount()) {
+        CHECK(kept->isValid() && model.lineAt(kept->row()) == next);
+    }
+
+    // folded repeats show their count on the first row of a run
+    filter.setAllLevelsChecked(true);
+    filter.setAllClassesChecked(true);
+    RepeatFolder folder;
+    folder.index(logFile->text(0, text.size()), table);
+    folder.fold(filter.visibleLines(), table);
+    if (!folder.runs().empty()) {
+        folder.setExpanded(folder.runs().front().line, true);
+        folder.fold(filter.visibleLines(), table);
+    }
+    lines = std::make_shared<const VisibleLines>(folder.visibleLines());
+    auto runs = std::make_shared<const RepeatRuns>(folder.runs());
+    model.setFilteredLines(document, lines, runs);
+    checkRows(model, *document, *lines, runs.get());
+
+    // filtered lines of a document that is no longer shown are dropped
+    auto other = std::make_shared<const LogDocument>(
+        logFile, logFile, 1, lineIndex, table, timeIndex, true);
+    model.setFilteredLines(other, std::make_shared<const VisibleLines>(),
+                           nullptr);
+    CHECK(model.document() == document);
+    checkRows(model, *document, *lines, runs.get());
+
+    // a new generation replaces every row
+    LineIndex firstLines;
+    LogTable firstTable;
+    LevelCounts firstCounts{};
+    parser.parse(logFile->text(0, text.size() / 2), false, firstLines,
+                 firstTable, firstCounts);
+    VisibleLines all;
+    all.reset(firstTable.size(), true);
+    auto replaced = std::make_shared<const LogDocument>(
+        logFile, logFile, 2, firstLines, firstTable, TimeIndex(), false);
+    model.setLogDocument(replaced, std::make_shared<const VisibleLines>(all),
+                         nullptr);
+    CHECK(!kept->isValid());
+    checkRows(model, *replaced, all, nullptr);
+
+    model.clear();
+    CHECK(model.rowCount() == 0 && model.document() == nullptr);
+}
+}  // namespace
+
+int main() {
+    testModel(makeTestLog(1, 3000, true));
+    std::remove(LogFileName);
+    return Check::result();
+}
@@ -0,0 +1,162 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LogRecordParser.h>
+#include <ParallelLogParser.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Column>
+bool equalColumns(const Column& a, const Column& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+// the vectorized scan finds every newline of random bytes, indexed at once
+// or in steps that split lines
+void testLineIndex() {
+    std::mt19937 random(1);
+    for (int round = 0; round < 200; round++) {
+        std::string text(random() % 3000, 'x');
+        for (auto& c : text) {
+            c = "ab\n\r\x80"[random() % 5];
+        }
+        std::vector<std::uint64_t> starts = {0};
+        for (std::size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '\n') {
+                starts.push_back(i + 1);
+            }
+        }
+        if (starts.back() != text.size()) {
+            starts.push_back(text.size());
+        }
+
+        LineIndex whole;
+        whole.build(text.data(), text.size());
+        CHECK(whole.lineCount() == starts.size() - 1);
+        for (std::size_t line = 0; line + 1 < starts.size(); line++) {
+            CHECK(whole.lineBegin(line) == starts[line]);
+            CHECK(whole.lineEnd(line) == starts[line + 1]);
+        }
+
+        LineIndex stepped;
+        std::uint64_t end = 0;
+        while (end < text.size()) {
+            end = std::min<std::uint64_t>(text.size(), end + random() % 200);
+            stepped.append(textPart(text, stepped.indexedSize(), end),
+                           end == text.size());
+        }
+        CHECK(stepped.lineCount() == whole.lineCount());
+        for (std::size_t line = 0; line < whole.lineCount(); line++) {
+            CHECK(stepped.lineBegin(line) == whole.lineBegin(line));
+            CHECK(stepped.lineEnd(line) == whole.lineEnd(line));
+        }
+        CHECK(stepped.endsWithPartialLine() == whole.endsWithPartialLine());
+    }
+}
+
+// parsing in chunks on any number of threads gives the table of a single
+// sequential pass over the whole text
+void testParallelParse(const std::string& text) {
+    LineIndex expectedIndex;
+    expectedIndex.build(text.data(), text.size());
+    LogTable expected;
+    LogRecordParser(expected).parse(LogText(text), expectedIndex, 0,
+                                    expectedIndex.lineCount());
+    LevelCounts expectedCounts{};
+    expected.countLevels(0, expectedCounts);
+
+    std::mt19937 random(2);
+    for (std::size_t threads : {1, 3, 8}) {
+        ThreadPool pool(threads);
+        ParallelLogParser parser(pool);
+        for (std::uint64_t maxStep : {std::uint64_t(4096),
+                                      std::uint64_t(3 * 1024 * 1024),
+                                      std::uint64_t(text.size())}) {
+            LineIndex lineIndex;
+            LogTable table;
+            LevelCounts counts{};
+            std::uint64_t end = 0;
+            while (end < text.size()) {
+                end = std::min<std::uint64_t>(text.size(),
+                                              end + random() % maxStep + 1);
+                parser.parse(textPart(text, lineIndex.indexedSize(), end),
+                             end == text.size(), lineIndex, table, counts);
+            }
+
+            CHECK(lineIndex.lineCount() == expectedIndex.lineCount());
+            for (std::size_t line = 0; line <= lineIndex.lineCount() &&
+                                       line <= expectedIndex.lineCount();
+                 line++) {
+                CHECK(lineIndex.lineBegin(line) ==
+                      expectedIndex.lineBegin(line));
+            }
+            CHECK(equalColumns(table.timestamps, expected.timestamps));
+            CHECK(equalColumns(table.levels, expected.levels));
+            CHECK(equalColumns(table.messageOffsets, expected.messageOffsets));
+            CHECK(equalColumns(table.messageLengths, expected.messageLengths));
+            CHECK(equalColumns(table.records, expected.records));
+            CHECK(counts == expectedCounts);
+            // chunks intern classes in their own order, names must agree
+            CHECK(table.classes.size() == expected.classes.size());
+            CHECK(table.classIds.size() == expected.classIds.size());
+            for (std::size_t row = 0; row < table.classIds.size() &&
+                                      row < expected.classIds.size();
+                 row++) {
+                auto id = table.classIds[row];
+                auto expectedId = expected.classIds[row];
+                CHECK((id == LogTable::NoClass) ==
+                      (expectedId == LogTable::NoClass));
+                if (id != LogTable::NoClass &&
+                    expectedId != LogTable::NoClass) {
+                    CHECK(table.classes.name(id) ==
+                          expected.classes.name(expectedId));
+                }
+            }
+        }
+    }
+}
+
+// records start at every header, continuation lines never start one
+void testRecords(const std::string& text) {
+    LineIndex lineIndex;
+    lineIndex.build(text.data(), text.size());
+    LogTable table;
+    LogRecordParser(table).parse(LogText(text), lineIndex, 0,
+                                 lineIndex.lineCount());
+    std::size_t record = 0;
+    for (std::size_t row = 0; row < table.size(); row++) {
+        if (row == 0 || table.levels[row] != LogTable::NoLevel) {
+            CHECK(record < table.recordCount() &&
+                  table.recordBegin(record) == row);
+            record++;
+        }
+        CHECK(table.recordOf(row) == record - 1);
+    }
+    CHECK(record == table.recordCount());
+}
+}  // namespace
+
+int main() {
+    testLineIndex();
+
+    auto text = makeTestLog(3, 50000, true);
+    text += "last line without line ending";
+    testParallelParse(text);
+    testRecords(text);
+
+    // the crash log repeated until it needs several chunks
+    auto crashLog = readTestData("20240508101620-CRASH.log");
+    CHECK(!crashLog.empty());
+    std::string repeated;
+    while (repeated.size() < 8 * 1024 * 1024 && !crashLog.empty()) {
+        repeated += crashLog;
+    }
+    testParallelParse(repeated);
+    testRecords(repeated);
+    return Check::result();
+}
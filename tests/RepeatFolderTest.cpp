@@ -0,0 +1,215 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LogTable.h>
+#include <ParallelLogParser.h>
+#include <RepeatFolder.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+#include <VisibleLines.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+bool isTokenChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z') || c == '_' || c == '-';
+}
+
+// level, class and message of a record with every token containing a digit
+// masked, records fold when theirs are equal
+std::string referenceKey(const std::string& text, const LogTable& table,
+                         std::size_t record) {
+    const auto header = table.recordBegin(record);
+    std::string key = std::to_string(table.levels[header]) + ' ' +
+                      std::to_string(table.classIds[header]) + ' ';
+    const auto message = std::string_view(text).substr(
+        table.messageOffsets[header], table.messageLengths[header]);
+    for (std::size_t i = 0; i < message.size();) {
+        if (!isTokenChar(message[i])) {
+            key += message[i++];
+            continue;
+        }
+        auto end = i;
+        while (end < message.size() && isTokenChar(message[end])) {
+            end++;
+        }
+        auto token = message.substr(i, end - i);
+        key += token.find_first_of("0123456789") != std::string_view::npos
+                   ? std::string_view("\x01")
+                   : token;
+        i = end;
+    }
+    return key;
+}
+
+// runs of equal keys among the visible records, the records after the
+// first of a run are hidden unless the run is expanded
+void checkFolded(const RepeatFolder& folder, const std::string& text,
+                 const LogTable& table, const VisibleLines& visible,
+                 const std::set<std::uint32_t>& expanded) {
+    RepeatRuns runs;
+    std::vector<bool> shown(table.size(), false);
+    RepeatRun run{0, 0, 0, false};
+    std::string runKey;
+    for (std::size_t record = 0; record < table.recordCount(); record++) {
+        const auto line = static_cast<std::uint32_t>(table.recordBegin(record));
+        if (!visible.contains(line)) {
+            continue;
+        }
+        auto key = referenceKey(text, table, record);
+        const bool joins = run.count != 0 && key == runKey;
+        if (joins) {
+            run.count++;
+            run.lastLine = line;
+        } else {
+            if (run.count > 1) {
+                runs.push_back(run);
+            }
+            run = {line, line, 1, expanded.count(line) != 0};
+            runKey = key;
+        }
+        if (!joins || run.expanded) {
+            for (auto shownLine = line; shownLine < table.recordEnd(record);
+                 shownLine++) {
+                shown[shownLine] = true;
+            }
+        }
+    }
+    if (run.count > 1) {
+        runs.push_back(run);
+    }
+
+    const auto& folded = folder.visibleLines();
+    CHECK(folded.lineCount() == table.size());
+    std::size_t count = 0;
+    for (std::uint32_t line = 0; line < folded.lineCount(); line++) {
+        CHECK(folded.contains(line) == shown[line]);
+        if (shown[line]) {
+            CHECK(folded.lineAt(count) == line);
+            count++;
+        }
+    }
+    CHECK(folded.size() == count);
+    CHECK(folder.runs().size() == runs.size());
+    for (std::size_t i = 0; i < runs.size() && i < folder.runs().size();
+         i++) {
+        const auto& actual = folder.runs()[i];
+        CHECK(actual.line == runs[i].line &&
+              actual.lastLine == runs[i].lastLine &&
+              actual.count == runs[i].count &&
+              actual.expanded == runs[i].expanded);
+    }
+}
+
+// few message shapes so that runs are common, with continuation lines
+std::string makeRepetitiveLog(std::uint32_t seed, std::size_t records) {
+    static const char* const levels[] = {"info", "warning"};
+    static const char* const messages[] = {"poll %d returned", "tick",
+                                           "id 0x%x done"};
+    std::mt19937 random(seed);
+    std::string text = "started\n";
+    char line[128];
+    for (std::size_t i = 0; i < records; i++) {
+        auto length = std::snprintf(
+            line, sizeof(line), "[2024-05-08 10:%02d:%02d.%03d][%s] %s",
+            static_cast<int>(i / 60000 % 60), static_cast<int>(i / 1000 % 60),
+            static_cast<int>(i % 1000), levels[random() % 5 == 0],
+            random() % 4 == 0 ? "" : "Poller -- ");
+        text.append(line, length);
+        length = std::snprintf(line, sizeof(line), messages[random() % 3],
+                               static_cast<int>(random() % 100));
+        text.append(line, length);
+        text += '\n';
+        if (random() % 6 == 0) {
+            text += "  detail\n";
+        }
+    }
+    return text;
+}
+
+// loads text in chunks, extending the folding of the grown table, and
+// compares with a fresh folding and with the reference after every chunk
+void testIncremental(const std::string& text, std::uint32_t seed) {
+    std::mt19937 random(seed);
+    ThreadPool pool(3);
+    ParallelLogParser parser(pool);
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    RepeatFolder folder;
+    const std::set<std::uint32_t> noneExpanded;
+    // records stay visible or hidden as the table grows
+    auto isVisible = [seed](std::size_t record) {
+        return (record * 2654435761u + seed) % 7 != 0;
+    };
+
+    std::uint64_t end = 0;
+    bool folded = false;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 100000 + 1);
+        auto loaded = textPart(text, lineIndex.indexedSize(), end);
+        parser.parse(loaded, end == text.size(), lineIndex, table, counts);
+        folder.index(loaded, table);
+        CHECK(folder.indexedRecords() == table.recordCount());
+
+        VisibleLines visible;
+        visible.reset(table.size(), false);
+        for (std::size_t record = 0; record < table.recordCount(); record++) {
+            for (auto line = table.recordBegin(record);
+                 isVisible(record) && line < table.recordEnd(record); line++) {
+                visible.set(static_cast<std::uint32_t>(line), true);
+            }
+        }
+        visible.updateRanks();
+        if (folded) {
+            folder.extend(visible, table);
+        } else {
+            folder.fold(visible, table);
+            folded = true;
+        }
+        checkFolded(folder, text, table, visible, noneExpanded);
+
+        RepeatFolder fresh;
+        fresh.index(textPart(text, 0, end), table);
+        fresh.fold(visible, table);
+        checkFolded(fresh, text, table, visible, noneExpanded);
+    }
+
+    // expanded runs keep all their records until they are collapsed again
+    std::set<std::uint32_t> expanded;
+    for (const auto& run : RepeatRuns(folder.runs())) {
+        if (random() % 3 == 0) {
+            folder.setExpanded(run.line, true);
+            expanded.insert(run.line);
+        }
+    }
+    VisibleLines visible;
+    visible.reset(table.size(), true);
+    folder.fold(visible, table);
+    checkFolded(folder, text, table, visible, expanded);
+    for (auto line : std::set<std::uint32_t>(expanded)) {
+        if (random() % 2 == 0) {
+            folder.setExpanded(line, false);
+            expanded.erase(line);
+        }
+    }
+    folder.fold(visible, table);
+    checkFolded(folder, text, table, visible, expanded);
+}
+}  // namespace
+
+int main() {
+    for (std::uint32_t seed = 0; seed < 3; seed++) {
+        testIncremental(makeRepetitiveLog(seed, 20000), seed);
+        testIncremental(makeTestLog(seed, 20000, true), seed);
+    }
+    return Check::result();
+}
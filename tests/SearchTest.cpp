@@ -0,0 +1,154 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LiteralFinder.h>
+#include <RegexLiteral.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+#include <TrigramIndex.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+char lower(char c) { return c >= 'A' && c <= 'Z' ? c | 0x20 : c; }
+char swapCase(char c) { return c >= 'a' && c <= 'z' ? c & ~0x20 : lower(c); }
+
+// offset of the first match in [begin, end) or end, byte by byte
+std::uint64_t naiveFind(const std::string& text, std::uint64_t begin,
+                        std::uint64_t end, const std::string& literal,
+                        bool matchCase) {
+    for (auto position = begin; position + literal.size() <= end;
+         position++) {
+        std::size_t i = 0;
+        for (; i < literal.size(); i++) {
+            auto a = text[position + i];
+            auto b = literal[i];
+            if (matchCase ? a != b : lower(a) != lower(b)) {
+                break;
+            }
+        }
+        if (i == literal.size()) {
+            return position;
+        }
+    }
+    return end;
+}
+
+// short texts of the bytes that trip up vectorized compares: both cases,
+// bytes above 0x7f and literals crossing the ends of a vector
+void testLiteralFinder() {
+    static const char bytes[] = "aAbB-\x8d\xe2zZ\n";
+    std::mt19937 random(7);
+    for (int round = 0; round < 100000; round++) {
+        std::string text(random() % 100, ' ');
+        for (auto& c : text) {
+            c = bytes[random() % 10];
+        }
+        std::string literal(random() % 4 + 1, ' ');
+        for (auto& c : literal) {
+            c = bytes[random() % 9];
+        }
+        auto matchCase = random() % 2 == 0;
+        auto begin = text.empty() ? 0 : random() % (text.size() + 1);
+        LiteralFinder finder(literal, matchCase);
+        CHECK(finder.find(text.data(), begin, text.size()) ==
+              naiveFind(text, begin, text.size(), literal, matchCase));
+    }
+}
+
+// every block with a line containing the literal is a candidate, in either
+// case, for an index built in parallel chunks
+void testTrigramCandidates() {
+    auto text = makeTestLog(11, 40000);
+    LineIndex lineIndex;
+    ThreadPool pool(4);
+    TrigramIndex index;
+    std::mt19937 random(12);
+    std::uint64_t end = 0;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 1000000 + 1);
+        auto loaded = textPart(text, lineIndex.indexedSize(), end);
+        lineIndex.append(loaded, end == text.size());
+        index.index(loaded, lineIndex, pool);
+    }
+    CHECK(index.lineCount() == lineIndex.lineCount());
+
+    std::vector<std::string> literals = {"probe_id=1", "PROBE_ID", "-- st",
+                                         "No such text", "Er", "xyz"};
+    for (int i = 0; i < 40; i++) {
+        // pieces of real lines, a few of them in another case. Queries
+        // never contain the line ending
+        auto line = random() % lineIndex.lineCount();
+        auto lineBegin = lineIndex.lineBegin(line);
+        auto lineSize = lineIndex.lineEnd(line) - lineBegin - 1;
+        auto length = std::min<std::uint64_t>(random() % 12 + 1, lineSize);
+        auto literal = text.substr(
+            lineBegin + random() % (lineSize - length + 1), length);
+        if (i % 4 == 0) {
+            std::transform(literal.begin(), literal.end(), literal.begin(),
+                           swapCase);
+        }
+        literals.push_back(literal);
+    }
+
+    for (const auto& literal : literals) {
+        auto blocks = index.candidateBlocks(literal);
+        CHECK(std::is_sorted(blocks.begin(), blocks.end()));
+        for (bool matchCase : {true, false}) {
+            for (std::size_t line = 0; line < lineIndex.lineCount(); line++) {
+                auto lineEnd = lineIndex.lineEnd(line);
+                if (naiveFind(text, lineIndex.lineBegin(line), lineEnd,
+                              literal, matchCase) == lineEnd) {
+                    continue;
+                }
+                std::uint32_t block = line / TrigramIndex::LinesPerBlock;
+                CHECK(std::binary_search(blocks.begin(), blocks.end(),
+                                         block));
+            }
+        }
+    }
+}
+
+void checkRequired(const char* pattern, const char* expected,
+                   bool matchCase = true) {
+    CHECK(RegexLiteral::required(pattern, matchCase) == expected);
+}
+
+// the literal every match of a pattern contains, or none when the pattern
+// leaves it open
+void testRegexLiteral() {
+    checkRequired("probe_id=-1", "probe_id=-1");
+    checkRequired("probe_id=-?1", "probe_id=");
+    checkRequired("foo|bar", "");
+    checkRequired("(foo|bar)baz", "baz");
+    checkRequired("ab*cdef", "cdef");
+    checkRequired("ab+cd", "ab");
+    checkRequired("abc+defg", "defg");
+    checkRequired("\\d+ms elapsed", "ms elapsed");
+    checkRequired("a\\.b\\.c", "a.b.c");
+    checkRequired("[abc]xyz", "xyz");
+    checkRequired("[]a]hello", "hello");
+    checkRequired("x{0,3}yz", "yz");
+    checkRequired("x{2}yz", "yz");
+    checkRequired("a{b", "a{b");
+    checkRequired("(?i)hello", "");
+    checkRequired("\\x41BCD", "");
+    checkRequired("^\\[2024-05-08 10:16:2\\d", "[2024-05-08 10:16:2");
+    checkRequired("caf\xc3\xa9s", "caf\xc3\xa9s");
+    checkRequired("caf\xc3\xa9s", "caf", false);
+    checkRequired("caf\xc3\xa9?s", "caf");
+    checkRequired("a.*b", "a");
+    checkRequired("", "");
+}
+}  // namespace
+
+int main() {
+    testLiteralFinder();
+    testTrigramCandidates();
+    testRegexLiteral();
+    return Check::result();
+}
@@ -0,0 +1,147 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LogTable.h>
+#include <ParallelLogParser.h>
+#include <TemplateMiner.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+// tokens of a message as the miner sees them, numbers masked
+std::vector<std::string> maskedTokens(std::string_view message) {
+    std::vector<std::string> tokens;
+    std::size_t position = 0;
+    while (position < message.size()) {
+        auto begin = message.find_first_not_of(" \t", position);
+        if (begin == std::string_view::npos) {
+            break;
+        }
+        auto end = std::min(message.find_first_of(" \t", begin),
+                            message.size());
+        std::string token(message.substr(begin, end - begin));
+        if (token.find_first_of("0123456789") != std::string::npos) {
+            token = "<*>";
+        }
+        tokens.push_back(token);
+        position = end;
+    }
+    return tokens;
+}
+
+std::vector<std::string> templateTokens(const TemplateMiner& miner,
+                                        std::uint32_t id) {
+    const auto text = miner.text(id);
+    return text.empty() ? std::vector<std::string>() : maskedTokens(text);
+}
+
+// parses text in chunks and mines the templates of every chunk
+void mine(const std::string& text, std::uint32_t seed, LogTable& table,
+          TemplateMiner& miner) {
+    std::mt19937 random(seed);
+    ThreadPool pool(3);
+    ParallelLogParser parser(pool);
+    LineIndex lineIndex;
+    LevelCounts counts{};
+    std::uint64_t end = 0;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 300000 + 1);
+        auto loaded = textPart(text, lineIndex.indexedSize(), end);
+        parser.parse(loaded, end == text.size(), lineIndex, table, counts);
+        miner.index(loaded, table);
+    }
+}
+
+// every record with a header gets a template of its class that matches its
+// message token by token, and the counts and times of a template are those
+// of its records
+void testReference(const std::string& text, std::uint32_t seed) {
+    LogTable table;
+    TemplateMiner miner;
+    mine(text, seed, table, miner);
+    CHECK(table.templateIds.size() == table.recordCount());
+
+    std::vector<std::uint64_t> counts(miner.size(), 0);
+    std::vector<std::int64_t> first(miner.size(), INT64_MAX);
+    std::vector<std::int64_t> last(miner.size(), INT64_MIN);
+    for (std::size_t record = 0; record < table.templateIds.size();
+         record++) {
+        const auto header = table.recordBegin(record);
+        const auto id = table.templateIds[record];
+        if (table.levels[header] == LogTable::NoLevel) {
+            CHECK(id == LogTable::NoTemplate);
+            continue;
+        }
+        if (id >= miner.size()) {
+            CHECK(id < miner.size());
+            continue;
+        }
+        CHECK(miner.at(id).classId == table.classIds[header]);
+        const auto message = std::string_view(text).substr(
+            table.messageOffsets[header], table.messageLengths[header]);
+        const auto tokens = maskedTokens(message);
+        const auto pattern = templateTokens(miner, id);
+        CHECK(tokens.size() == pattern.size());
+        for (std::size_t i = 0; i < tokens.size() && i < pattern.size();
+             i++) {
+            CHECK(pattern[i] == "<*>" || pattern[i] == tokens[i]);
+        }
+        counts[id]++;
+        first[id] = std::min(first[id], table.timestamps[header]);
+        last[id] = std::max(last[id], table.timestamps[header]);
+    }
+    for (std::uint32_t id = 0; id < miner.size(); id++) {
+        CHECK(miner.at(id).count == counts[id]);
+        CHECK(miner.at(id).first == first[id]);
+        CHECK(miner.at(id).last == last[id]);
+    }
+    // a handful of message shapes, not a template per record
+    CHECK(miner.size() < 100);
+}
+
+// messages that are equal once masked share one template, also when
+// numbers make up most of their tokens
+void testMaskedMessages() {
+    std::string text;
+    char line[128];
+    for (int i = 0; i < 1000; i++) {
+        auto length = std::snprintf(
+            line, sizeof(line),
+            "[2024-05-08 10:00:%02d.%03d][info] Net -- GET /v1/items %d %dms\n",
+            i / 1000 % 60, i % 1000, i * 7, i % 90);
+        text.append(line, length);
+    }
+    text += "[2024-05-08 10:00:59.000][info] Net -- 1 2 3 4\n";
+    text += "[2024-05-08 10:00:59.001][info] Net -- 5 6 7 8\n";
+
+    LogTable table;
+    TemplateMiner miner;
+    mine(text, 1, table, miner);
+    CHECK(miner.size() == 2);
+    CHECK(table.templateIds.size() == 1002);
+    for (std::size_t record = 1; record < 1000; record++) {
+        CHECK(table.templateIds[record] == table.templateIds[0]);
+    }
+    const auto id = table.templateIds[0];
+    CHECK(miner.text(id) == "GET <*> <*> <*>");
+    CHECK(miner.at(id).count == 1000);
+    CHECK(table.templateIds[1000] == table.templateIds[1001]);
+    CHECK(miner.at(table.templateIds[1000]).count == 2);
+}
+}  // namespace
+
+int main() {
+    testMaskedMessages();
+    for (std::uint32_t seed = 0; seed < 4; seed++) {
+        testReference(makeTestLog(seed, 30000, seed % 2 == 0), seed);
+    }
+    return Check::result();
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <LogText.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+// reproducible spdlog text in the pattern LogRecordParser reads: records of
+// every level, a few classes and messages that only differ in numbers,
+// multi-line records, windows line endings, records without class and the
+// odd record logged out of time order. A preamble puts lines without
+// header before the first record
+inline std::string makeTestLog(std::uint32_t seed, std::size_t records,
+                               bool preamble = false) {
+    static const char* const levels[] = {"trace", "debug",   "info",
+                                         "warning", "error", "critical",
+                                         "warn"};
+    static const char* const classes[] = {"Data3d", "ProbeManager",
+                                          "Network", "Ui"};
+    static const char* const messages[] = {
+        "updateWorldTransform called, id: %d", "probe_id=%d connected",
+        "request %d took 12 ms", "state changed to %d"};
+    static const char* const continuations[] = {
+        "    at frame %d", "SELECT * FROM probes WHERE id = %d",
+        "  {\"id\": %d, \"state\": \"Error\"}"};
+
+    std::mt19937 random(seed);
+    std::string text;
+    if (preamble) {
+        text += "log started\n  pid 4242\n";
+    }
+    std::int64_t milliseconds = 36000000;  // 10:00:00
+    char line[256];
+    for (std::size_t i = 0; i < records; i++) {
+        milliseconds += random() % 50;
+        auto time = milliseconds - (random() % 20 == 0 ? 300 : 0);
+        auto length = std::snprintf(
+            line, sizeof(line), "[2024-05-08 %02d:%02d:%02d.%03d][%s] ",
+            static_cast<int>(time / 3600000),
+            static_cast<int>(time / 60000 % 60),
+            static_cast<int>(time / 1000 % 60),
+            static_cast<int>(time % 1000), levels[random() % 7]);
+        text.append(line, length);
+        if (random() % 10 != 0) {
+            text += classes[random() % 4];
+            text += " -- ";
+        }
+        length = std::snprintf(line, sizeof(line), messages[random() % 4],
+                               static_cast<int>(random() % 1000));
+        text.append(line, length);
+        text += random() % 10 == 0 ? "\r\n" : "\n";
+        if (random() % 8 == 0) {
+            for (auto count = random() % 4 + 1; count > 0; count--) {
+                length = std::snprintf(line, sizeof(line),
+                                       continuations[random() % 3],
+                                       static_cast<int>(i));
+                text.append(line, length);
+                text += '\n';
+            }
+        }
+    }
+    return text;
+}
+
+// content of a file of the data directory
+inline std::string readTestData(const char* fileName) {
+    std::ifstream file(std::string(LOGREADER_TEST_DATA_DIR) + "/" + fileName,
+                       std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+// bytes [begin, end) of text as loading reads them, without the bytes
+// before so a consumer reading outside them trips the sanitizers
+inline LogText textPart(const std::string& text, std::uint64_t begin,
+                        std::uint64_t end) {
+    return LogText(text.data() + begin, begin, end);
+}
@@ -0,0 +1,101 @@
+#include <Check.h>
+#include <LineIndex.h>
+#include <LogTable.h>
+#include <ParallelLogParser.h>
+#include <TestLogs.h>
+#include <ThreadPool.h>
+#include <TimeIndex.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace {
+// the time index of a log loaded in chunks answers like a scan over the
+// timestamps of its records, lines before the first header have no time
+// and fall in every range
+void testReference(const std::string& text, std::uint32_t seed) {
+    std::mt19937 random(seed);
+    ThreadPool pool(2);
+    ParallelLogParser parser(pool);
+    LineIndex lineIndex;
+    LogTable table;
+    LevelCounts counts{};
+    TimeIndex timeIndex;
+
+    std::uint64_t end = 0;
+    while (end < text.size()) {
+        end = std::min<std::uint64_t>(text.size(),
+                                      end + random() % 200000 + 1);
+        parser.parse(textPart(text, lineIndex.indexedSize(), end),
+                     end == text.size(), lineIndex, table, counts);
+        timeIndex.index(table);
+        CHECK(timeIndex.rowCount() == table.size());
+
+        std::size_t preamble = 0;
+        while (preamble < table.size() &&
+               table.levels[preamble] == LogTable::NoLevel) {
+            preamble++;
+        }
+        CHECK(timeIndex.preambleRows() == preamble);
+        auto minimum = std::numeric_limits<std::int64_t>::max();
+        auto maximum = std::numeric_limits<std::int64_t>::min();
+        for (auto row = preamble; row < table.size(); row++) {
+            minimum = std::min(minimum, table.timestamps[row]);
+            maximum = std::max(maximum, table.timestamps[row]);
+        }
+        if (preamble == table.size()) {
+            minimum = maximum = 0;
+        }
+        CHECK(timeIndex.minimum() == minimum);
+        CHECK(timeIndex.maximum() == maximum);
+
+        for (int round = 0; round < 20; round++) {
+            const auto from = minimum + static_cast<std::int64_t>(
+                                            random() % 120) * 1000000 -
+                              10000000;
+            const auto to =
+                from + static_cast<std::int64_t>(random() % 60) * 1000000;
+            for (std::size_t word = 0; word * 64 < table.size(); word++) {
+                std::uint64_t bits = 0;
+                for (std::size_t i = 0; i < 64 && word * 64 + i < table.size();
+                     i++) {
+                    const auto row = word * 64 + i;
+                    const bool inRange = row < preamble ||
+                                         (table.timestamps[row] >= from &&
+                                          table.timestamps[row] <= to);
+                    CHECK(timeIndex.isInRange(row, from, to) == inRange);
+                    bits |= static_cast<std::uint64_t>(inRange) << i;
+                }
+                const auto mask =
+                    table.size() - word * 64 >= 64
+                        ? ~std::uint64_t(0)
+                        : (std::uint64_t(1) << (table.size() - word * 64)) - 1;
+                CHECK((timeIndex.rangeBits(word, from, to) & mask) == bits);
+            }
+
+            // the first record at or after a time
+            auto expected = preamble;
+            while (expected < table.size() &&
+                   table.timestamps[expected] < from) {
+                expected++;
+            }
+            CHECK(timeIndex.lowerBound(from) == expected);
+        }
+    }
+}
+}  // namespace
+
+int main() {
+    testReference(makeTestLog(1, 20000), 1);
+    testReference(makeTestLog(2, 20000, true), 2);
+    // a long preamble spanning blocks, found while loading
+    std::string preamble;
+    for (int line = 0; line < 3000; line++) {
+        preamble += "  starting up\n";
+    }
+    testReference(preamble + makeTestLog(3, 20000), 3);
+    return Check::result();
+}